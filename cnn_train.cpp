@@ -0,0 +1,499 @@
+// Alat za treniranje malog CNN-a za prepoznavanje ranka i suita iz ugla karte.
+//
+// Mreža se trenira u float preciznosti na sintetičkim uglovima 33x90 koji se
+// slažu od šablona iz Card_Imgs (rank gore, suit ispod, nasumična veličina,
+// pomjeraj, kontrast, zamućenje i šum), zatim se kvantizuje na int8 i upisuje
+// u cnn_weights.h koji main.cpp uključuje. Nije potreban nikakav ML runtime.
+//
+// Kompajliranje i pokretanje:
+//   g++ -O3 -march=native cnn_train.cpp -o cnn_train
+//   ./cnn_train [broj_koraka] > cnn_weights.h
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+// Arhitektura mora odgovarati inferenci u main.cpp (konstante se izvoze u header)
+const int IN_W = 33, IN_H = 90;
+const int C1 = 8, C2 = 16, C3 = 24;
+const int POOL_BANDS_X = 2, POOL_BANDS_Y = 3;
+const int FEAT = C3 * POOL_BANDS_X * POOL_BANDS_Y;
+const int N_RANK = 13, N_SUIT = 4, N_OUT = N_RANK + N_SUIT;
+
+const std::vector<std::string> RANK_FILES = {
+    "Card_Imgs/Ranks/2.jpg", "Card_Imgs/Ranks/3.jpg", "Card_Imgs/Ranks/4.jpg", "Card_Imgs/Ranks/5.jpg",
+    "Card_Imgs/Ranks/6.jpg", "Card_Imgs/Ranks/7.jpg", "Card_Imgs/Ranks/8.jpg", "Card_Imgs/Ranks/9.jpg",
+    "Card_Imgs/Ranks/0.jpg", "Card_Imgs/Ranks/jack.jpg", "Card_Imgs/Ranks/queen.jpg",
+    "Card_Imgs/Ranks/king.jpg", "Card_Imgs/Ranks/ace.jpg"
+};
+const std::vector<std::string> SUIT_FILES = {
+    "Card_Imgs/Suits/hearts.jpg", "Card_Imgs/Suits/diamonds.jpg",
+    "Card_Imgs/Suits/clubs.jpg", "Card_Imgs/Suits/spades.jpg"
+};
+
+struct Glyph {
+    int w, h;
+    std::vector<float> ink;   // 1 = simbol, 0 = pozadina
+};
+
+Glyph load_glyph(const std::string& file) {
+    int w, h, c;
+    unsigned char* data = stbi_load(file.c_str(), &w, &h, &c, 1);
+    if (!data) {
+        std::cerr << "Greska pri ucitavanju sablona: " << file << std::endl;
+        exit(1);
+    }
+    Glyph g{w, h, std::vector<float>(w * h)};
+    for (int i = 0; i < w * h; ++i) g.ink[i] = data[i] / 255.0f;
+    stbi_image_free(data);
+    return g;
+}
+
+// Bilinearno iscrtavanje šablona u pravougaonik (x0, y0, w, h) platna
+void draw_glyph(std::vector<float>& canvas, const Glyph& g, float x0, float y0, float w, float h) {
+    for (int y = std::max(0, (int)y0); y < std::min(IN_H, (int)std::ceil(y0 + h)); ++y)
+        for (int x = std::max(0, (int)x0); x < std::min(IN_W, (int)std::ceil(x0 + w)); ++x) {
+            float u = (x + 0.5f - x0) / w * g.w - 0.5f;
+            float v = (y + 0.5f - y0) / h * g.h - 0.5f;
+            if (u < 0 || v < 0 || u > g.w - 1 || v > g.h - 1) continue;
+            int x1 = (int)u, y1 = (int)v;
+            int x2 = std::min(x1 + 1, g.w - 1), y2 = std::min(y1 + 1, g.h - 1);
+            float dx = u - x1, dy = v - y1;
+            float val = (1 - dx) * (1 - dy) * g.ink[y1 * g.w + x1] + dx * (1 - dy) * g.ink[y1 * g.w + x2] +
+                        (1 - dx) * dy * g.ink[y2 * g.w + x1] + dx * dy * g.ink[y2 * g.w + x2];
+            canvas[y * IN_W + x] = std::max(canvas[y * IN_W + x], val);
+        }
+}
+
+// Ista normalizacija kao cnn_prepare_input u main.cpp: invertovanje i razvlačenje na 0..127
+void normalize_input(const std::vector<unsigned char>& gray, std::vector<uint8_t>& q) {
+    int lo = 255, hi = 0;
+    for (unsigned char v : gray) { lo = std::min<int>(lo, v); hi = std::max<int>(hi, v); }
+    int range = std::max(1, hi - lo);
+    q.resize(gray.size());
+    for (size_t i = 0; i < gray.size(); ++i) q[i] = (uint8_t)((hi - gray[i]) * 127 / range);
+}
+
+struct Sample {
+    std::vector<uint8_t> input;
+    int rank, suit;
+};
+
+Sample synth_sample(const std::vector<Glyph>& ranks, const std::vector<Glyph>& suits, std::mt19937& rng) {
+    auto uni = [&](float a, float b) { return std::uniform_real_distribution<float>(a, b)(rng); };
+
+    Sample s;
+    s.rank = rng() % N_RANK;
+    s.suit = rng() % N_SUIT;
+
+    std::vector<float> ink(IN_W * IN_H, 0.0f);
+    float rh = uni(15, 40), rw = rh * uni(0.45f, 1.0f);
+    rw = std::min(rw, (float)IN_W - 1);
+    float rx = uni(0, IN_W - rw), ry = uni(0, 22);
+    draw_glyph(ink, ranks[s.rank], rx, ry, rw, rh);
+
+    float sh = uni(10, 28), sw = std::min(sh * uni(0.8f, 1.15f), (float)IN_W - 1);
+    float sx = std::clamp(rx + rw / 2 - sw / 2 + uni(-4, 4), 0.0f, IN_W - sw);
+    float sy = ry + rh + uni(1, 9);
+    draw_glyph(ink, suits[s.suit], sx, sy, sw, sh);
+
+    // Ivica stola/okvira koja ponekad uđe u isječak
+    if (uni(0, 1) < 0.3f) {
+        int band = (int)uni(1, 6);
+        for (int y = 0; y < IN_H; ++y)
+            for (int x = 0; x < band; ++x) ink[y * IN_W + x] = 1.0f;
+    }
+    if (uni(0, 1) < 0.2f) {
+        int band = (int)uni(1, 5);
+        for (int y = 0; y < band; ++y)
+            for (int x = 0; x < IN_W; ++x) ink[y * IN_W + x] = 1.0f;
+    }
+
+    // Blago zamućenje
+    if (uni(0, 1) < 0.5f) {
+        std::vector<float> tmp(ink);
+        for (int y = 1; y < IN_H - 1; ++y)
+            for (int x = 1; x < IN_W - 1; ++x) {
+                float acc = 0;
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx) acc += tmp[(y + dy) * IN_W + x + dx];
+                ink[y * IN_W + x] = acc / 9.0f;
+            }
+    }
+
+    float bg = uni(140, 255), fg = uni(0, 100), noise = uni(0, 12);
+    std::normal_distribution<float> nd(0.0f, 1.0f);
+    std::vector<unsigned char> gray(IN_W * IN_H);
+    for (int i = 0; i < IN_W * IN_H; ++i) {
+        float v = bg + (fg - bg) * ink[i] + noise * nd(rng);
+        gray[i] = (unsigned char)std::clamp(v, 0.0f, 255.0f);
+    }
+    normalize_input(gray, s.input);
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Float mreža (HWC raspored)
+// ---------------------------------------------------------------------------
+
+struct Conv {
+    int cin, cout;
+    std::vector<float> w, b;          // w[cout][3][3][cin]
+    std::vector<float> gw, gb, mw, vw, mb, vb;
+
+    Conv(int ci, int co, std::mt19937& rng) : cin(ci), cout(co), w(co * 9 * ci), b(co, 0.0f),
+        gw(w.size()), gb(co), mw(w.size()), vw(w.size()), mb(co), vb(co) {
+        std::normal_distribution<float> nd(0.0f, std::sqrt(2.0f / (9 * ci)));
+        for (auto& v : w) v = nd(rng);
+    }
+};
+
+// Konvolucija 3x3, padding 1, ReLU
+void conv_forward(const Conv& c, const std::vector<float>& in, int W, int H, std::vector<float>& out) {
+    out.assign(W * H * c.cout, 0.0f);
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x) {
+            float* o = &out[(y * W + x) * c.cout];
+            for (int co = 0; co < c.cout; ++co) o[co] = c.b[co];
+            for (int ky = 0; ky < 3; ++ky) {
+                int iy = y + ky - 1;
+                if (iy < 0 || iy >= H) continue;
+                for (int kx = 0; kx < 3; ++kx) {
+                    int ix = x + kx - 1;
+                    if (ix < 0 || ix >= W) continue;
+                    const float* ip = &in[(iy * W + ix) * c.cin];
+                    for (int co = 0; co < c.cout; ++co) {
+                        const float* wp = &c.w[((co * 3 + ky) * 3 + kx) * c.cin];
+                        float acc = 0;
+                        for (int ci = 0; ci < c.cin; ++ci) acc += ip[ci] * wp[ci];
+                        o[co] += acc;
+                    }
+                }
+            }
+            for (int co = 0; co < c.cout; ++co) o[co] = std::max(0.0f, o[co]);
+        }
+}
+
+// dOut je gradijent po izlazu konvolucije (posle ReLU); out služi kao ReLU maska
+void conv_backward(Conv& c, const std::vector<float>& in, int W, int H, const std::vector<float>& out,
+                   std::vector<float>& dOut, std::vector<float>* dIn) {
+    if (dIn) dIn->assign(W * H * c.cin, 0.0f);
+    for (size_t i = 0; i < dOut.size(); ++i)
+        if (out[i] <= 0) dOut[i] = 0;
+
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x) {
+            const float* g = &dOut[(y * W + x) * c.cout];
+            for (int co = 0; co < c.cout; ++co) c.gb[co] += g[co];
+            for (int ky = 0; ky < 3; ++ky) {
+                int iy = y + ky - 1;
+                if (iy < 0 || iy >= H) continue;
+                for (int kx = 0; kx < 3; ++kx) {
+                    int ix = x + kx - 1;
+                    if (ix < 0 || ix >= W) continue;
+                    const float* ip = &in[(iy * W + ix) * c.cin];
+                    float* dip = dIn ? &(*dIn)[(iy * W + ix) * c.cin] : nullptr;
+                    for (int co = 0; co < c.cout; ++co) {
+                        float gv = g[co];
+                        if (gv == 0) continue;
+                        float* gwp = &c.gw[((co * 3 + ky) * 3 + kx) * c.cin];
+                        const float* wp = &c.w[((co * 3 + ky) * 3 + kx) * c.cin];
+                        for (int ci = 0; ci < c.cin; ++ci) gwp[ci] += gv * ip[ci];
+                        if (dip)
+                            for (int ci = 0; ci < c.cin; ++ci) dip[ci] += gv * wp[ci];
+                    }
+                }
+            }
+        }
+}
+
+void maxpool_forward(const std::vector<float>& in, int W, int H, int C, std::vector<float>& out, std::vector<int>& arg) {
+    int OW = W / 2, OH = H / 2;
+    out.assign(OW * OH * C, 0.0f);
+    arg.assign(OW * OH * C, 0);
+    for (int y = 0; y < OH; ++y)
+        for (int x = 0; x < OW; ++x)
+            for (int c = 0; c < C; ++c) {
+                float best = -1e30f;
+                int bi = 0;
+                for (int dy = 0; dy < 2; ++dy)
+                    for (int dx = 0; dx < 2; ++dx) {
+                        int idx = ((2 * y + dy) * W + 2 * x + dx) * C + c;
+                        if (in[idx] > best) { best = in[idx]; bi = idx; }
+                    }
+                out[(y * OW + x) * C + c] = best;
+                arg[(y * OW + x) * C + c] = bi;
+            }
+}
+
+void band_bounds(int n, int bands, int b, int& lo, int& hi) {
+    lo = b * n / bands;
+    hi = (b + 1) * n / bands;
+}
+
+void bandpool_forward(const std::vector<float>& in, int W, int H, std::vector<float>& out, std::vector<int>& arg) {
+    out.assign(FEAT, 0.0f);
+    arg.assign(FEAT, 0);
+    for (int by = 0; by < POOL_BANDS_Y; ++by)
+        for (int bx = 0; bx < POOL_BANDS_X; ++bx) {
+            int y0, y1, x0, x1;
+            band_bounds(H, POOL_BANDS_Y, by, y0, y1);
+            band_bounds(W, POOL_BANDS_X, bx, x0, x1);
+            for (int c = 0; c < C3; ++c) {
+                float best = -1e30f;
+                int bi = 0;
+                for (int y = y0; y < y1; ++y)
+                    for (int x = x0; x < x1; ++x) {
+                        int idx = (y * W + x) * C3 + c;
+                        if (in[idx] > best) { best = in[idx]; bi = idx; }
+                    }
+                int o = (by * POOL_BANDS_X + bx) * C3 + c;
+                out[o] = best;
+                arg[o] = bi;
+            }
+        }
+}
+
+struct Net {
+    Conv c1, c2, c3;
+    std::vector<float> wd, bd, gwd, gbd, mwd, vwd, mbd, vbd;   // wd[N_OUT][FEAT]
+
+    explicit Net(std::mt19937& rng) : c1(1, C1, rng), c2(C1, C2, rng), c3(C2, C3, rng),
+        wd(N_OUT * FEAT), bd(N_OUT, 0.0f), gwd(wd.size()), gbd(N_OUT), mwd(wd.size()), vwd(wd.size()),
+        mbd(N_OUT), vbd(N_OUT) {
+        std::normal_distribution<float> nd(0.0f, std::sqrt(1.0f / FEAT));
+        for (auto& v : wd) v = nd(rng);
+    }
+};
+
+struct Activations {
+    std::vector<float> x0, a1, p1, a2, p2, a3, p3, feat, logits;
+    std::vector<int> arg1, arg2, arg3, argf;
+};
+
+const int W1 = IN_W, H1 = IN_H;
+const int W2 = W1 / 2, H2 = H1 / 2;
+const int W3 = W2 / 2, H3 = H2 / 2;
+const int W4 = W3 / 2, H4 = H3 / 2;
+
+void forward(const Net& n, const std::vector<uint8_t>& input, Activations& a) {
+    a.x0.resize(IN_W * IN_H);
+    for (int i = 0; i < IN_W * IN_H; ++i) a.x0[i] = input[i] / 127.0f;
+    conv_forward(n.c1, a.x0, W1, H1, a.a1);
+    maxpool_forward(a.a1, W1, H1, C1, a.p1, a.arg1);
+    conv_forward(n.c2, a.p1, W2, H2, a.a2);
+    maxpool_forward(a.a2, W2, H2, C2, a.p2, a.arg2);
+    conv_forward(n.c3, a.p2, W3, H3, a.a3);
+    maxpool_forward(a.a3, W3, H3, C3, a.p3, a.arg3);
+    bandpool_forward(a.p3, W4, H4, a.feat, a.argf);
+    a.logits.assign(N_OUT, 0.0f);
+    for (int o = 0; o < N_OUT; ++o) {
+        float acc = n.bd[o];
+        for (int i = 0; i < FEAT; ++i) acc += n.wd[o * FEAT + i] * a.feat[i];
+        a.logits[o] = acc;
+    }
+}
+
+void softmax_grad(const float* logits, int n, int label, float* grad, float& loss) {
+    float mx = *std::max_element(logits, logits + n), sum = 0;
+    for (int i = 0; i < n; ++i) { grad[i] = std::exp(logits[i] - mx); sum += grad[i]; }
+    for (int i = 0; i < n; ++i) grad[i] /= sum;
+    loss += -std::log(std::max(grad[label], 1e-12f));
+    grad[label] -= 1.0f;
+}
+
+float backward(Net& n, Activations& a, int rank, int suit) {
+    float loss = 0;
+    std::vector<float> dl(N_OUT);
+    softmax_grad(&a.logits[0], N_RANK, rank, &dl[0], loss);
+    softmax_grad(&a.logits[N_RANK], N_SUIT, suit, &dl[N_RANK], loss);
+
+    std::vector<float> dfeat(FEAT, 0.0f);
+    for (int o = 0; o < N_OUT; ++o) {
+        n.gbd[o] += dl[o];
+        for (int i = 0; i < FEAT; ++i) {
+            n.gwd[o * FEAT + i] += dl[o] * a.feat[i];
+            dfeat[i] += dl[o] * n.wd[o * FEAT + i];
+        }
+    }
+
+    std::vector<float> dp3(a.p3.size(), 0.0f);
+    for (int i = 0; i < FEAT; ++i) dp3[a.argf[i]] += dfeat[i];
+    std::vector<float> da3(a.a3.size(), 0.0f);
+    for (size_t i = 0; i < dp3.size(); ++i) da3[a.arg3[i]] += dp3[i];
+
+    std::vector<float> dp2;
+    conv_backward(n.c3, a.p2, W3, H3, a.a3, da3, &dp2);
+    std::vector<float> da2(a.a2.size(), 0.0f);
+    for (size_t i = 0; i < dp2.size(); ++i) da2[a.arg2[i]] += dp2[i];
+
+    std::vector<float> dp1;
+    conv_backward(n.c2, a.p1, W2, H2, a.a2, da2, &dp1);
+    std::vector<float> da1(a.a1.size(), 0.0f);
+    for (size_t i = 0; i < dp1.size(); ++i) da1[a.arg1[i]] += dp1[i];
+
+    conv_backward(n.c1, a.x0, W1, H1, a.a1, da1, nullptr);
+    return loss;
+}
+
+void adam(std::vector<float>& w, std::vector<float>& g, std::vector<float>& m, std::vector<float>& v,
+          float lr, int t, float scale) {
+    const float b1 = 0.9f, b2 = 0.999f, eps = 1e-8f;
+    float c1 = 1 - std::pow(b1, (float)t), c2 = 1 - std::pow(b2, (float)t);
+    for (size_t i = 0; i < w.size(); ++i) {
+        float gi = g[i] * scale;
+        m[i] = b1 * m[i] + (1 - b1) * gi;
+        v[i] = b2 * v[i] + (1 - b2) * gi * gi;
+        w[i] -= lr * (m[i] / c1) / (std::sqrt(v[i] / c2) + eps);
+        g[i] = 0;
+    }
+}
+
+void step(Net& n, float lr, int t, int batch) {
+    float s = 1.0f / batch;
+    for (Conv* c : {&n.c1, &n.c2, &n.c3}) {
+        adam(c->w, c->gw, c->mw, c->vw, lr, t, s);
+        adam(c->b, c->gb, c->mb, c->vb, lr, t, s);
+    }
+    adam(n.wd, n.gwd, n.mwd, n.vwd, lr, t, s);
+    adam(n.bd, n.gbd, n.mbd, n.vbd, lr, t, s);
+}
+
+int argmax(const float* v, int n) {
+    return (int)(std::max_element(v, v + n) - v);
+}
+
+// ---------------------------------------------------------------------------
+// Kvantizacija i izvoz
+// ---------------------------------------------------------------------------
+
+// Realni množilac -> (mult, shift) tako da je x * real ≈ (x * mult) >> shift
+void quantize_multiplier(double real, int32_t& mult, int& shift) {
+    shift = 0;
+    while (real * (1LL << shift) < (1LL << 30) && shift < 62) ++shift;
+    mult = (int32_t)std::llround(real * (1LL << shift));
+}
+
+struct QConv {
+    std::vector<int8_t> w;
+    std::vector<int32_t> bias, mult;
+    std::vector<int> shift;
+};
+
+QConv quantize_conv(const Conv& c, float inScale, float outScale) {
+    QConv q;
+    int k = 9 * c.cin;
+    q.w.resize(c.w.size());
+    for (int co = 0; co < c.cout; ++co) {
+        float mx = 1e-8f;
+        for (int i = 0; i < k; ++i) mx = std::max(mx, std::fabs(c.w[co * k + i]));
+        float ws = mx / 127.0f;
+        for (int i = 0; i < k; ++i) q.w[co * k + i] = (int8_t)std::lround(c.w[co * k + i] / ws);
+        q.bias.push_back((int32_t)std::lround(c.b[co] / (inScale * ws)));
+        int32_t m; int sh;
+        quantize_multiplier((double)inScale * ws / outScale, m, sh);
+        q.mult.push_back(m);
+        q.shift.push_back(sh);
+    }
+    return q;
+}
+
+template <typename T>
+void emit_array(const char* type, const char* name, const std::vector<T>& v) {
+    printf("static const %s %s[%zu] = {", type, name, v.size());
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (i % 16 == 0) printf("\n    ");
+        printf("%lld,", (long long)v[i]);
+    }
+    printf("\n};\n\n");
+}
+
+int main(int argc, char** argv) {
+    int steps = argc > 1 ? std::atoi(argv[1]) : 6000;
+    const int batch = 16;
+
+    std::vector<Glyph> ranks, suits;
+    for (const auto& f : RANK_FILES) ranks.push_back(load_glyph(f));
+    for (const auto& f : SUIT_FILES) suits.push_back(load_glyph(f));
+
+    std::mt19937 rng(12345);
+    Net net(rng);
+    Activations a;
+
+    float runLoss = 0;
+    for (int t = 1; t <= steps; ++t) {
+        float lr = t < steps * 3 / 4 ? 2e-3f : 5e-4f;
+        for (int b = 0; b < batch; ++b) {
+            Sample s = synth_sample(ranks, suits, rng);
+            forward(net, s.input, a);
+            runLoss = 0.99f * runLoss + 0.01f * backward(net, a, s.rank, s.suit);
+        }
+        step(net, lr, t, batch);
+        if (t % 200 == 0) std::cerr << "korak " << t << " loss " << runLoss << std::endl;
+    }
+
+    // Kalibracija opsega aktivacija i tačnost na svježim uzorcima
+    float max1 = 0, max2 = 0, max3 = 0;
+    int okRank = 0, okSuit = 0;
+    const int calib = 2000;
+    std::vector<Sample> calibSet;
+    for (int i = 0; i < calib; ++i) {
+        Sample s = synth_sample(ranks, suits, rng);
+        forward(net, s.input, a);
+        for (float v : a.a1) max1 = std::max(max1, v);
+        for (float v : a.a2) max2 = std::max(max2, v);
+        for (float v : a.a3) max3 = std::max(max3, v);
+        okRank += argmax(&a.logits[0], N_RANK) == s.rank;
+        okSuit += argmax(&a.logits[N_RANK], N_SUIT) == s.suit;
+    }
+    std::cerr << "float tacnost: rank " << okRank * 100.0 / calib << "% suit " << okSuit * 100.0 / calib << "%" << std::endl;
+
+    const float s0 = 1.0f / 127.0f, s1 = max1 / 127.0f, s2 = max2 / 127.0f, s3 = max3 / 127.0f;
+    QConv q1 = quantize_conv(net.c1, s0, s1);
+    QConv q2 = quantize_conv(net.c2, s1, s2);
+    QConv q3 = quantize_conv(net.c3, s2, s3);
+
+    // Potpuno povezani sloj: jedna skala za sve izlaze da bi logiti bili uporedivi
+    float mxd = 1e-8f;
+    for (float v : net.wd) mxd = std::max(mxd, std::fabs(v));
+    float wds = mxd / 127.0f;
+    std::vector<int8_t> qwd(net.wd.size());
+    for (size_t i = 0; i < net.wd.size(); ++i) qwd[i] = (int8_t)std::lround(net.wd[i] / wds);
+    std::vector<int32_t> qbd(N_OUT);
+    for (int o = 0; o < N_OUT; ++o) qbd[o] = (int32_t)std::lround(net.bd[o] / (s3 * wds));
+
+    printf("// Generisano alatom cnn_train.cpp (%d koraka, batch %d) - ne mijenjati rucno.\n", steps, batch);
+    printf("// float tacnost na sintetickim uglovima: rank %.1f%%, suit %.1f%%\n",
+           okRank * 100.0 / calib, okSuit * 100.0 / calib);
+    printf("#pragma once\n\n#include <cstdint>\n\n");
+    printf("const int CNN_IN_W = %d, CNN_IN_H = %d;\n", IN_W, IN_H);
+    printf("const int CNN_C1 = %d, CNN_C2 = %d, CNN_C3 = %d;\n", C1, C2, C3);
+    printf("const int CNN_BANDS_X = %d, CNN_BANDS_Y = %d;\n", POOL_BANDS_X, POOL_BANDS_Y);
+    printf("const int CNN_N_RANK = %d, CNN_N_SUIT = %d;\n\n", N_RANK, N_SUIT);
+    printf("// Konvolucije: w[cout][3][3][cin], izlaz = clamp((acc + bias) * mult >> shift, 0, 127)\n");
+    emit_array("int8_t", "cnn_w1", q1.w);
+    emit_array("int32_t", "cnn_b1", q1.bias);
+    emit_array("int32_t", "cnn_m1", q1.mult);
+    emit_array("int8_t", "cnn_s1", q1.shift);
+    emit_array("int8_t", "cnn_w2", q2.w);
+    emit_array("int32_t", "cnn_b2", q2.bias);
+    emit_array("int32_t", "cnn_m2", q2.mult);
+    emit_array("int8_t", "cnn_s2", q2.shift);
+    emit_array("int8_t", "cnn_w3", q3.w);
+    emit_array("int32_t", "cnn_b3", q3.bias);
+    emit_array("int32_t", "cnn_m3", q3.mult);
+    emit_array("int8_t", "cnn_s3", q3.shift);
+    printf("// Potpuno povezani sloj: wd[%d][%d], logit = acc + bias (zajednička skala)\n", N_OUT, FEAT);
+    emit_array("int8_t", "cnn_wd", qwd);
+    emit_array("int32_t", "cnn_bd", qbd);
+    return 0;
+}
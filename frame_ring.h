@@ -0,0 +1,85 @@
+// Zajednički raspored POSIX shared-memory prstena frejmova između procesa koji
+// snima (shm_producer.cpp ili kamera) i prepoznavača (main --shm=/ime).
+//
+// Memorija: FrameRingHeader, pa slotCount slotova po slotBytes bajtova. Svaki slot
+// počinje sa FrameSlotHeader, a pikseli slijede od FRAME_SLOT_DATA_OFFSET.
+// Proizvođač piše frejm n u slot n % slotCount kao seqlock (seq neparan dok
+// piše, pa 2 * (n + 1) kad je gotov), zatim povećava published i budi čitaoce
+// futexom na published. Čitalac obrađuje piksele na mjestu i poslije ponovo
+// provjerava seq; ako se promijenio, proizvođač je u međuvremenu prepisao slot.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __linux__
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const uint32_t FRAME_RING_MAGIC = 0x4B525246; // "FRRK"
+const uint32_t FRAME_RING_VERSION = 1;
+const size_t FRAME_SLOT_DATA_OFFSET = 64;
+
+// Formati piksela (isti redoslijed kao PixelFormat u main.cpp)
+enum FrameRingFormat : uint32_t { FRAME_RGB = 0, FRAME_GRAY = 1, FRAME_NV12 = 2, FRAME_I420 = 3 };
+
+struct FrameSlotHeader {
+    std::atomic<uint64_t> seq;
+    uint32_t format;
+    uint32_t width, height;
+    uint32_t stride;        // bajtova po redu RGB/Y ravni; hroma ravni prate NV12/I420 konvenciju
+    uint32_t bytes;         // korisnih bajtova iza FRAME_SLOT_DATA_OFFSET
+    uint64_t timestampNs;   // CLOCK_MONOTONIC u trenutku snimanja
+};
+static_assert(sizeof(FrameSlotHeader) <= FRAME_SLOT_DATA_OFFSET, "zaglavlje slota je preveliko");
+
+struct FrameRingHeader {
+    std::atomic<uint32_t> magic;      // upisuje se posljednji, kad je ostatak zaglavlja spreman
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotBytes;               // uključuje zaglavlje slota, poravnato na 64
+    alignas(64) std::atomic<uint32_t> published; // broj objavljenih frejmova (futex riječ)
+    std::atomic<uint32_t> closed;     // proizvođač je završio
+    std::atomic<uint32_t> waiters;    // čitaoci koji spavaju na futexu
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "prsten zahtijeva lock-free atomike");
+
+inline size_t frame_ring_size(uint32_t slotCount, uint32_t slotBytes) {
+    return sizeof(FrameRingHeader) + (size_t)slotCount * slotBytes;
+}
+
+inline uint32_t frame_slot_bytes(size_t maxFrameBytes) {
+    return (uint32_t)((FRAME_SLOT_DATA_OFFSET + maxFrameBytes + 63) & ~(size_t)63);
+}
+
+inline FrameSlotHeader* frame_ring_slot(FrameRingHeader* ring, uint64_t frame) {
+    unsigned char* base = reinterpret_cast<unsigned char*>(ring) + sizeof(FrameRingHeader);
+    return reinterpret_cast<FrameSlotHeader*>(base + (frame % ring->slotCount) * ring->slotBytes);
+}
+
+inline unsigned char* frame_slot_data(FrameSlotHeader* slot) {
+    return reinterpret_cast<unsigned char*>(slot) + FRAME_SLOT_DATA_OFFSET;
+}
+
+#ifdef __linux__
+// Futex između procesa (bez FUTEX_PRIVATE_FLAG jer je memorija dijeljena)
+inline void frame_ring_wait(FrameRingHeader* ring, uint32_t seen, int timeoutMs) {
+    ring->waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (ring->published.load(std::memory_order_seq_cst) == seen && !ring->closed.load()) {
+        timespec ts = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&ring->published), FUTEX_WAIT, seen, &ts, nullptr, 0);
+    }
+    ring->waiters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+inline void frame_ring_wake(FrameRingHeader* ring) {
+    if (ring->waiters.load(std::memory_order_seq_cst) > 0)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&ring->published), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#endif
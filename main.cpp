@@ -11,6 +11,380 @@
 #include <algorithm>
 #include <iostream>
 #include <string>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <fstream>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <cstdarg>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <deque>
+
+#include "cnn_weights.h"
+#include "frame_ring.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <csignal>
+#include <cerrno>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Asinhroni log: svaka nit formatira poruke u svoj lock-free ring (jedan
+// proizvođač, jedan potrošač), a pozadinska nit ih prazni i piše u stdout/stderr.
+// Nivoi ispod LOG_COMPILE_LEVEL se uklanjaju pri kompajliranju
+// (npr. g++ -DLOG_COMPILE_LEVEL=2 main.cpp za produkciju bez Trace/Debug poruka).
+// ---------------------------------------------------------------------------
+
+// Result je izlaz programa (prepoznata karta): uvijek prolazi filter i ide na stdout
+enum class LogLevel { Trace = 0, Debug = 1, Info = 2, Warn = 3, Error = 4, Result = 5 };
+
+inline FILE* log_stream(LogLevel lvl) {
+    return lvl >= LogLevel::Warn && lvl != LogLevel::Result ? stderr : stdout;
+}
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 1
+#endif
+
+const int LOG_MSG_MAX = 240;
+const size_t LOG_RING_SIZE = 1024;   // stepen dvojke
+const size_t LOG_MAX_THREADS = 256;
+
+struct LogRecord {
+    uint8_t level;
+    uint16_t len;
+    char text[LOG_MSG_MAX];
+};
+
+struct LogRing {
+    alignas(64) std::atomic<size_t> head{0};   // piše samo vlasnik niti
+    alignas(64) std::atomic<size_t> tail{0};   // piše samo pozadinska nit
+    LogRecord records[LOG_RING_SIZE];
+};
+
+class Logger {
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    std::atomic<int> level{(int)LogLevel::Info};
+
+    void write(LogLevel lvl, const char* fmt, va_list args) {
+        LogRing* ringPtr = thread_ring();
+        if (!ringPtr) {
+            // Više niti nego mjesta za ringove: sinhroni ispis
+            std::lock_guard<std::mutex> lock(drainMutex);
+            FILE* out = log_stream(lvl);
+            vfprintf(out, fmt, args);
+            fputc('\n', out);
+            return;
+        }
+        LogRing& ring = *ringPtr;
+        size_t head = ring.head.load(std::memory_order_relaxed);
+
+        // Pun ring: dijagnostika se odbacuje, rezultati i greške čekaju
+        while (head - ring.tail.load(std::memory_order_acquire) >= LOG_RING_SIZE) {
+            if (lvl < LogLevel::Info) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            wake();
+            std::this_thread::yield();
+        }
+
+        LogRecord& rec = ring.records[head & (LOG_RING_SIZE - 1)];
+        int n = vsnprintf(rec.text, LOG_MSG_MAX, fmt, args);
+        rec.len = (uint16_t)std::clamp(n, 0, LOG_MSG_MAX - 1);
+        rec.level = (uint8_t)lvl;
+        ring.head.store(head + 1, std::memory_order_release);
+
+        // Fence uparen sa sleeping.store u run(): ili pozadinska nit vidi novi
+        // zapis, ili ovdje vidimo da spava i budimo je
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) wake();
+    }
+
+    // Sinhrono pražnjenje (npr. prije izlaska ili pri mjerenju)
+    void flush() {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drain_all();
+    }
+
+    ~Logger() {
+        stop.store(true);
+        wake();
+        if (worker.joinable()) worker.join();
+        drain_all();
+        if (dropped.load())
+            fprintf(stderr, "[log] odbaceno %zu dijagnostickih poruka\n", dropped.load());
+    }
+
+private:
+    std::mutex ringsMutex;                        // samo pri registraciji nove niti
+    std::vector<std::unique_ptr<LogRing>> owned;
+    LogRing* rings[LOG_MAX_THREADS] = {};
+    std::atomic<size_t> ringCount{0};
+    std::mutex drainMutex;
+    std::mutex sleepMutex;
+    std::condition_variable wakeCv;
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> dropped{0};
+    std::thread worker;
+
+    Logger() : worker([this] { run(); }) {}
+
+    LogRing* thread_ring() {
+        thread_local LogRing* ring = nullptr;
+        if (!ring) {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            size_t n = ringCount.load(std::memory_order_relaxed);
+            if (n == LOG_MAX_THREADS) return nullptr;
+            owned.push_back(std::make_unique<LogRing>());
+            ring = rings[n] = owned.back().get();
+            ringCount.store(n + 1, std::memory_order_release);
+        }
+        return ring;
+    }
+
+    void wake() {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeCv.notify_one();
+    }
+
+    bool drain_all() {
+        size_t count = ringCount.load(std::memory_order_acquire);
+        bool any = false, wroteOut = false, wroteErr = false;
+        for (size_t i = 0; i < count; ++i) {
+            LogRing& ring = *rings[i];
+            size_t tail = ring.tail.load(std::memory_order_relaxed);
+            size_t head = ring.head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail) {
+                LogRecord& rec = ring.records[tail & (LOG_RING_SIZE - 1)];
+                FILE* out = log_stream((LogLevel)rec.level);
+                fwrite(rec.text, 1, rec.len, out);
+                fputc('\n', out);
+                (out == stderr ? wroteErr : wroteOut) = true;
+            }
+            if (tail != ring.tail.load(std::memory_order_relaxed)) {
+                ring.tail.store(tail, std::memory_order_release);
+                any = true;
+            }
+        }
+        if (wroteOut) fflush(stdout);
+        if (wroteErr) fflush(stderr);
+        return any;
+    }
+
+    bool rings_empty() {
+        size_t count = ringCount.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+            if (rings[i]->head.load(std::memory_order_acquire) != rings[i]->tail.load(std::memory_order_relaxed))
+                return false;
+        return true;
+    }
+
+    void run() {
+        while (!stop.load()) {
+            bool any;
+            {
+                std::lock_guard<std::mutex> lock(drainMutex);
+                any = drain_all();
+            }
+            if (any) continue;
+
+            // Spavaj dok proizvođač ne javi; sleeping se postavlja pod sleepMutex
+            // pa proizvođačev notify ne može da promakne
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (rings_empty() && !stop.load())
+                wakeCv.wait_for(lock, std::chrono::milliseconds(50));
+            sleeping.store(false);
+        }
+    }
+};
+
+inline bool log_enabled(LogLevel lvl) {
+    return (int)lvl >= Logger::instance().level.load(std::memory_order_relaxed);
+}
+
+void log_flush() {
+    Logger::instance().flush();
+}
+
+__attribute__((format(printf, 2, 3)))
+void log_write(LogLevel lvl, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    Logger::instance().write(lvl, fmt, args);
+    va_end(args);
+}
+
+#define LOG_AT(lvl, ...)                                                   \
+    do {                                                                   \
+        if constexpr ((int)(lvl) >= LOG_COMPILE_LEVEL) {                   \
+            if (log_enabled(lvl)) log_write(lvl, __VA_ARGS__);             \
+        }                                                                  \
+    } while (0)
+
+#define LOG_TRACE(...) LOG_AT(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+#define LOG_RESULT(...) LOG_AT(LogLevel::Result, __VA_ARGS__)
+
+// ---------------------------------------------------------------------------
+// Debug slike: isključene po defaultu. Kad su uključene, slike jednog frejma
+// se skupljaju kao dijeljeni baferi i na kraju frejma predaju pozadinskoj niti
+// koja ih kodira i snima. Red je ograničen: ako je pun, frejm se odbacuje
+// umjesto da prepoznavanje čeka na disk.
+// ---------------------------------------------------------------------------
+
+enum class DebugMode { Off = 0, All = 1, LowConfidence = 2 };
+
+const size_t DEBUG_QUEUE_MAX = 4;          // frejmova koji čekaju na upis
+const float LOW_CONFIDENCE_MARGIN = 0.10f; // relativna razlika najboljeg i drugog kandidata
+
+struct DebugImage {
+    std::string name;
+    int width, height, channels;
+    std::shared_ptr<const std::vector<unsigned char>> pixels;
+};
+
+class DebugWriter {
+public:
+    static DebugWriter& instance() {
+        static DebugWriter writer;
+        return writer;
+    }
+
+    std::atomic<int> mode{(int)DebugMode::Off};
+
+    // Slike tekućeg frejma ove niti
+    static std::vector<DebugImage>& pending() {
+        thread_local std::vector<DebugImage> images;
+        return images;
+    }
+
+    void submit(std::vector<DebugImage> frame) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (!worker.joinable()) worker = std::thread(&DebugWriter::run, this);
+            if (frames.size() >= DEBUG_QUEUE_MAX) {
+                ++dropped;
+                return;
+            }
+            frames.push_back(std::move(frame));
+        }
+        queueCv.notify_one();
+    }
+
+    ~DebugWriter() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCv.notify_one();
+        if (worker.joinable()) worker.join();
+        if (dropped) LOG_WARN("Odbaceno frejmova sa debug slikama: %zu", dropped);
+    }
+
+private:
+    DebugWriter() = default;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queueCv.wait(lock, [this] { return stopping || !frames.empty(); });
+            if (frames.empty()) return;
+            std::vector<DebugImage> frame = std::move(frames.front());
+            frames.pop_front();
+            lock.unlock();
+            for (const auto& img : frame) write(img);
+            lock.lock();
+        }
+    }
+
+    static void write(const DebugImage& img) {
+        const std::string& n = img.name;
+        bool jpg = n.size() > 4 && n.compare(n.size() - 4, 4, ".jpg") == 0;
+        int ok = jpg ? stbi_write_jpg(n.c_str(), img.width, img.height, img.channels, img.pixels->data(), 90)
+                     : stbi_write_png(n.c_str(), img.width, img.height, img.channels, img.pixels->data(),
+                                      img.width * img.channels);
+        if (!ok) LOG_ERROR("Greska pri snimanju debug slike: %s", n.c_str());
+    }
+
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::deque<std::vector<DebugImage>> frames;
+    std::thread worker;
+    bool stopping = false;
+    size_t dropped = 0;
+};
+
+inline bool debug_enabled() {
+    return DebugWriter::instance().mode.load(std::memory_order_relaxed) != (int)DebugMode::Off;
+}
+
+// Dodaje sliku u tekući frejm; bafer se preuzima bez kopiranja
+inline void debug_image(const std::string& name, int width, int height, int channels,
+                        std::vector<unsigned char> pixels) {
+    if (!debug_enabled()) return;
+    DebugWriter::pending().push_back(
+        {name, width, height, channels, std::make_shared<const std::vector<unsigned char>>(std::move(pixels))});
+}
+
+// Završava frejm: slike idu na upis ako su uključene sve, ili ako je rezultat nesiguran
+inline void debug_end_frame(bool lowConfidence) {
+    auto& images = DebugWriter::pending();
+    if (images.empty()) return;
+    std::vector<DebugImage> frame;
+    frame.swap(images);
+    DebugMode mode = (DebugMode)DebugWriter::instance().mode.load(std::memory_order_relaxed);
+    if (mode == DebugMode::All || (mode == DebugMode::LowConfidence && lowConfidence))
+        DebugWriter::instance().submit(std::move(frame));
+}
+
+// Slike tekućeg frejma se mogu prenijeti u drugu nit (npr. sljedeći stepen pipeline-a)
+inline std::vector<DebugImage> debug_take_frame() {
+    std::vector<DebugImage> frame;
+    frame.swap(DebugWriter::pending());
+    return frame;
+}
+
+inline void debug_resume_frame(std::vector<DebugImage> frame) {
+    auto& images = DebugWriter::pending();
+    images.insert(images.end(), std::make_move_iterator(frame.begin()), std::make_move_iterator(frame.end()));
+}
+
+// Relativna razlika između najboljeg i drugog najboljeg rezultata (manje = bolje)
+inline float match_margin(float best, float second) {
+    if (second <= best) return 0.0f;
+    if (second >= 1e29f || second <= 0.0f) return 1.0f;
+    return (second - best) / second;
+}
 
 // Dodajte ove deklaracije na početak fajla
 std::string putTextString(int rank);
@@ -19,32 +393,304 @@ std::string suitToString(int suit) {
     return (suit >= 0 && suit < 4) ? names[suit] : "Unknown";
 }
 
-int rankMatcher(const std::vector<unsigned char>& rnk_img, int rnk_width, int rnk_height);
-int matchSuit(const std::vector<unsigned char>& suitImg, int width, int height);
+int rankMatcher(const std::vector<unsigned char>& rnk_img, int rnk_width, int rnk_height, float* margin = nullptr);
+int matchSuit(const std::vector<unsigned char>& suitImg, int width, int height, unsigned candidates = 0xF,
+              float* margin = nullptr);
+
+// Šabloni za rank (vrijednost za putTextString) i suit (vrijednost za suitToString)
+const std::vector<std::pair<std::string, int>> RANK_TEMPLATES = {
+    {"Card_Imgs/Ranks/2.jpg", 1}, {"Card_Imgs/Ranks/3.jpg", 2},
+    {"Card_Imgs/Ranks/4.jpg", 3}, {"Card_Imgs/Ranks/5.jpg", 4},
+    {"Card_Imgs/Ranks/6.jpg", 5}, {"Card_Imgs/Ranks/7.jpg", 6},
+    {"Card_Imgs/Ranks/8.jpg", 7}, {"Card_Imgs/Ranks/9.jpg", 8},
+    {"Card_Imgs/Ranks/0.jpg", 9}, {"Card_Imgs/Ranks/jack.jpg", 10},
+    {"Card_Imgs/Ranks/queen.jpg", 11}, {"Card_Imgs/Ranks/king.jpg", 12},
+    {"Card_Imgs/Ranks/ace.jpg", 13}
+};
 
+const std::vector<std::pair<std::string, int>> SUIT_TEMPLATES = {
+    {"Card_Imgs/Suits/hearts.jpg", 0},
+    {"Card_Imgs/Suits/diamonds.jpg", 1},
+    {"Card_Imgs/Suits/clubs.jpg", 2},
+    {"Card_Imgs/Suits/spades.jpg", 3}
+};
 
-std::vector<unsigned char> load_image_grayscale(const std::string& filepath, int& width, int& height) {
-    // Učitavanje slike u RGB formatu
-    int channels;
-    unsigned char* image = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
+// Skup šablona kao sive slike iste veličine (0.3 R + 0.59 G + 0.11 B, kao binarize).
+// Veličina je od prvog učitanog šablona; šablon koji se ne učita ili je druge veličine
+// se preskače. Svaki matcher od ovoga gradi svoj oblik šablona.
+struct TemplateSet {
+    int width = 0, height = 0;
+    std::vector<int> labels;
+    std::vector<std::vector<unsigned char>> gray;  // width x height po šablonu
+};
 
-    if (image == nullptr) {
-        std::cerr << "Ne mogu da učitam sliku: " << filepath << std::endl;
-        exit(1);
+TemplateSet load_template_set(const std::vector<std::pair<std::string, int>>& templates) {
+    TemplateSet set;
+    for (const auto& [file, label] : templates) {
+        int w, h, c;
+        unsigned char* data = stbi_load(file.c_str(), &w, &h, &c, 0);
+        if (!data) {
+            LOG_ERROR("Failed to load template %s", file.c_str());
+            continue;
+        }
+        if (set.labels.empty()) {
+            set.width = w;
+            set.height = h;
+        }
+        if (w != set.width || h != set.height) {
+            LOG_ERROR("Sablon %s nije %dx%d", file.c_str(), set.width, set.height);
+            stbi_image_free(data);
+            continue;
+        }
+        std::vector<unsigned char> gray((size_t)w * h);
+        for (int i = 0; i < w * h; ++i) {
+            const unsigned char* px = data + (size_t)i * c;
+            gray[i] = c < 3 ? px[0] : (unsigned char)(px[0] * 0.3 + px[1] * 0.59 + px[2] * 0.11);
+        }
+        stbi_image_free(data);
+        set.labels.push_back(label);
+        set.gray.push_back(std::move(gray));
+    }
+    return set;
+}
+
+// Boja simbola: hearts/diamonds su crveni, clubs/spades crni. Maska kandidata
+// ima bit (1 << suit) za svaki suit koji matcher treba da uporedi.
+enum class SuitColor { Unknown, Red, Black };
+
+const unsigned SUIT_ALL = 0xF;
+const unsigned SUIT_RED = (1u << 0) | (1u << 1);
+const unsigned SUIT_BLACK = (1u << 2) | (1u << 3);
+
+const float REDNESS_THRESHOLD = 40.0f;   // prag prosječnog r - max(g, b) između crne i crvene
+const float REDNESS_MARGIN = 20.0f;      // odluka se prihvata samo ako je dalje od praga
+
+// Prosjek r - max(g, b) po pikselima simbola (binary == 0). Crveni otisak daje
+// ~100, crni ~0, pa je jedan prolaz dovoljan za pouzdanu odluku o boji.
+float ink_redness(const unsigned char* rgb, const std::vector<unsigned char>& binary) {
+    long sum = 0;
+    int n = 0;
+    for (size_t i = 0; i < binary.size(); ++i) {
+        if (binary[i] != 0) continue;
+        const unsigned char* p = rgb + i * 3;
+        sum += (int)p[0] - std::max(p[1], p[2]);
+        ++n;
+    }
+    return n ? (float)sum / n : 0.0f;
+}
+
+SuitColor classify_suit_color(float redness) {
+    if (redness > REDNESS_THRESHOLD + REDNESS_MARGIN) return SuitColor::Red;
+    if (redness < REDNESS_THRESHOLD - REDNESS_MARGIN) return SuitColor::Black;
+    return SuitColor::Unknown;
+}
+
+unsigned suit_candidates(SuitColor color) {
+    switch (color) {
+        case SuitColor::Red: return SUIT_RED;
+        case SuitColor::Black: return SUIT_BLACK;
+        default: return SUIT_ALL;
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+// Histogram sivih nivoa i Otsu prag: histogram se puni usput, u istom prolazu
+// kao konverzija u grayscale, pa automatski prag ne traži još jedno čitanje slike
+// ---------------------------------------------------------------------------
+
+using GrayHistogram = std::array<uint32_t, 256>;
+
+const int GRAY_HIST_PARALLEL_MIN = 1 << 20; // manje ravni se obrađuju u jednoj niti
+const int GRAY_HIST_MAX_THREADS = 4;
+
+// Nit koja je već jedna od paralelnih radnih niti (--pipeline, --watch) radi sve trake sama
+thread_local bool bandsOnCaller = false;
+
+// Pomoćne niti za trake velikih ravni prave se jednom, pa frejm ne plaća pokretanje niti.
+// Istovremeno radi jedan posao; traku 0 radi pozivalac.
+class BandPool {
+public:
+    static BandPool& instance() {
+        static BandPool pool;
+        return pool;
+    }
+
+    // Broj traka za ravan od pixels piksela
+    int bands(int64_t pixels) const {
+        if (bandsOnCaller || pixels < GRAY_HIST_PARALLEL_MIN) return 1;
+        return (int)workers.size() + 1;
+    }
+
+    void run(int count, const std::function<void(int)>& fn) {
+        if (count <= 1) {
+            fn(0);
+            return;
+        }
+        std::lock_guard<std::mutex> runLock(runMutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobBands = count;
+            pending = count - 1;
+            ++generation;
+        }
+        start.notify_all();
+        fn(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return pending == 0; });
+        job = nullptr;
+    }
+
+    ~BandPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        start.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+private:
+    BandPool() {
+        int threads = std::min<int>(GRAY_HIST_MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+        for (int band = 1; band < threads; ++band) workers.emplace_back(&BandPool::worker_loop, this, band);
+    }
+
+    void worker_loop(int band) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            start.wait(lock, [&] { return stop || generation != seen; });
+            if (stop) return;
+            seen = generation;
+            if (band >= jobBands) continue;
+            const std::function<void(int)>* fn = job;
+            lock.unlock();
+            (*fn)(band);
+            lock.lock();
+            if (--pending == 0) finished.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex runMutex, mutex;
+    std::condition_variable start, finished;
+    const std::function<void(int)>* job = nullptr;
+    int jobBands = 0, pending = 0;
+    uint64_t generation = 0;
+    bool stop = false;
+};
+
+// Redovi [y0, y1) ravni: RGB -> sivo u gray (kad je rgb), inače se src čita kao siva ravan.
+// Četiri pod-histograma naizmjenično, da uzastopni isti pikseli ne čekaju jedan na drugi.
+void gray_rows_histogram(const unsigned char* src, int srcStride, bool rgb, int width, int y0, int y1,
+                         unsigned char* gray, GrayHistogram* hist) {
+    uint32_t sub[4][256] = {};
+    for (int y = y0; y < y1; ++y) {
+        const unsigned char* row = src + (size_t)y * srcStride;
+        const unsigned char* out = row;
+        if (rgb) {
+            unsigned char* dst = gray + (size_t)y * width;
+            for (int x = 0; x < width; ++x) {
+                unsigned char r = row[x * 3], g = row[x * 3 + 1], b = row[x * 3 + 2];
+                dst[x] = static_cast<unsigned char>(0.299 * r + 0.587 * g + 0.114 * b);
+            }
+            out = dst;
+        }
+        if (!hist) continue;
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            ++sub[0][out[x]];
+            ++sub[1][out[x + 1]];
+            ++sub[2][out[x + 2]];
+            ++sub[3][out[x + 3]];
+        }
+        for (; x < width; ++x) ++sub[0][out[x]];
+    }
+    if (hist)
+        for (int i = 0; i < 256; ++i) (*hist)[i] = sub[0][i] + sub[1][i] + sub[2][i] + sub[3][i];
+}
+
+// Cijela ravan (gray je width x height bez paddinga, koristi se samo za RGB). Veliki frejmovi
+// se dijele na trake redova (BandPool); svaka traka puni svoj histogram, a oni se sabiraju na kraju.
+void gray_plane_histogram(const unsigned char* src, int srcStride, bool rgb, int width, int height,
+                          unsigned char* gray, GrayHistogram* hist) {
+    BandPool& pool = BandPool::instance();
+    int threads = pool.bands((int64_t)width * height);
+    if (threads == 1) {
+        gray_rows_histogram(src, srcStride, rgb, width, 0, height, gray, hist);
+        return;
+    }
+    std::vector<GrayHistogram> partial(threads);
+    pool.run(threads, [&](int t) {
+        gray_rows_histogram(src, srcStride, rgb, width, height * t / threads, height * (t + 1) / threads, gray,
+                            hist ? &partial[t] : nullptr);
+    });
+    if (!hist) return;
+    hist->fill(0);
+    for (const auto& p : partial)
+        for (int i = 0; i < 256; ++i) (*hist)[i] += p[i];
+}
+
+// Otsu: prag koji maksimizuje varijansu između klasa (<= prag i > prag). Kad u histogramu
+// nema dvije klase (prazna ili jednobojna slika), vraća fallback.
+int otsu_threshold(const GrayHistogram& hist, int fallback) {
+    uint64_t total = 0, sumAll = 0;
+    for (int i = 0; i < 256; ++i) {
+        total += hist[i];
+        sumAll += (uint64_t)i * hist[i];
     }
+    uint64_t wB = 0, sumB = 0;
+    double best = -1.0;
+    int threshold = fallback;
+    for (int i = 0; i < 256; ++i) {
+        wB += hist[i];
+        if (wB == 0) continue;
+        uint64_t wF = total - wB;
+        if (wF == 0) break;
+        sumB += (uint64_t)i * hist[i];
+        double diff = (double)sumB / wB - (double)(sumAll - sumB) / wF;
+        double between = (double)wB * wF * diff * diff;
+        if (between > best) {
+            best = between;
+            threshold = i;
+        }
+    }
+    return threshold;
+}
 
+// Pretvaranje slike u grayscale (koristeći jednostavan weighted sum za RGB); hist, ako je zadat,
+// dobija histogram rezultata iz istog prolaza
+std::vector<unsigned char> rgb_to_grayscale(const unsigned char* image, int width, int height, int channels,
+                                            GrayHistogram* hist = nullptr) {
     std::vector<unsigned char> grayscale_data;
     grayscale_data.reserve(width * height);
+    if (hist) hist->fill(0);
 
-    // Pretvaranje slike u grayscale (koristeći jednostavan weighted sum za RGB)
     for (int i = 0; i < width * height; ++i) {
         int r = image[i * channels + 0];
         int g = image[i * channels + 1];
         int b = image[i * channels + 2];
         unsigned char gray = static_cast<unsigned char>(0.3 * r + 0.59 * g + 0.11 * b); // Standardna formula za grayscale
         grayscale_data.push_back(gray);
+        if (hist) ++(*hist)[gray];
+    }
+    return grayscale_data;
+}
+
+std::vector<unsigned char> load_image_grayscale(const std::string& filepath, int& width, int& height) {
+    // Učitavanje slike u RGB formatu
+    int channels;
+    unsigned char* image = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
+
+    if (image == nullptr) {
+        LOG_ERROR("Ne mogu da učitam sliku: %s", filepath.c_str());
+        exit(1);
     }
 
+    std::vector<unsigned char> grayscale_data = rgb_to_grayscale(image, width, height, channels);
+
     // Oslobađanje memorije za originalnu sliku
     stbi_image_free(image);
     return grayscale_data;
@@ -58,6 +704,23 @@ float distance(Point2f a, Point2f b) {
     return std::sqrt((a.x - b.x)*(a.x - b.x) + (a.y - b.y)*(a.y - b.y));
 } //pitagora
 
+// Uglovi u redoslijedu za warp; položena karta (šira nego viša) se okreće uspravno
+std::array<Point2f, 4> orient_corners(Point2f topLeft, Point2f topRight, Point2f bottomRight, Point2f bottomLeft) {
+    float widthA = distance(topLeft, topRight);
+    float widthB = distance(bottomLeft, bottomRight);
+    float heightA = distance(topLeft, bottomLeft);
+    float heightB = distance(topRight, bottomRight);
+
+    float avgWidth = (widthA + widthB) / 2.0f;
+    float avgHeight = (heightA + heightB) / 2.0f;
+
+    if (avgWidth > avgHeight) {
+        return { bottomLeft, topLeft, topRight, bottomRight };
+    }
+
+    return { topLeft, topRight, bottomRight, bottomLeft };
+}
+
 std::array<Point2f, 4> find_corners(const std::vector<Point2f>& points) {
     Point2f topLeft = points[0], topRight = points[0], bottomRight = points[0], bottomLeft = points[0];
     float minSum = 1e9, maxSum = -1e9, minDiff = 1e9, maxDiff = -1e9;
@@ -72,28 +735,188 @@ std::array<Point2f, 4> find_corners(const std::vector<Point2f>& points) {
         if (diff > maxDiff) { maxDiff = diff; bottomLeft = p; }
     }
 
-    float widthA = distance(topLeft, topRight);
-    float widthB = distance(bottomLeft, bottomRight);
-    float heightA = distance(topLeft, bottomLeft);
-    float heightB = distance(topRight, bottomRight);
+    return orient_corners(topLeft, topRight, bottomRight, bottomLeft);
+}
 
-    float avgWidth = (widthA + widthB) / 2.0f;
-    float avgHeight = (heightA + heightB) / 2.0f;
+// Binarizacija ravni sa proizvoljnim korakom reda (npr. Y ravan YUV frejma)
+std::vector<unsigned char> binarize_plane(const unsigned char* gray, int width, int height, int stride, int threshold) {
+    std::vector<unsigned char> binary(width * height);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = gray + (size_t)y * stride;
+        for (int x = 0; x < width; ++x)
+            binary[y * width + x] = (row[x] > threshold) ? 255 : 0;
+    }
+    return binary;
+}
 
-    if (avgWidth > avgHeight) {
-        return { bottomLeft, topLeft, topRight, bottomRight };
+std::vector<unsigned char> binarize_image(const std::vector<unsigned char>& gray, int width, int height, int threshold) {
+    return binarize_plane(gray.data(), width, height, width, threshold);
+}
+
+// ---------------------------------------------------------------------------
+// Integralna slika i adaptivna binarizacija: suma i suma kvadrata svakog
+// prozora u O(1), pa prag zavisi od lokalnog osvjetljenja, a cijena ne zavisi
+// od veličine prozora
+// ---------------------------------------------------------------------------
+
+// Prag binarizacije: fiksan (120 za frejm, 100/120 za ugao), Bradley (lokalna srednja
+// vrijednost), Sauvola (srednja vrijednost i standardna devijacija) ili Otsu (jedan
+// automatski prag iz histograma slike)
+enum class ThresholdMode { Fixed, Bradley, Sauvola, Otsu };
+
+const float BRADLEY_T = 0.15f;       // piksel je taman ako je 15% ispod lokalne srednje vrijednosti
+const float SAUVOLA_K = 0.2f, SAUVOLA_R = 128.0f;
+const float ADAPTIVE_MIN_STD = 6.0f; // ravni prozori (unutrašnjost karte, sto) koriste fiksni prag
+
+#if defined(__x86_64__) || defined(__i386__)
+bool cpu_has_avx2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#else
+bool cpu_has_avx2() { return false; }
+#endif
+
+// (width + 1) x (height + 1), prvi red i kolona su nule
+struct IntegralImage {
+    int width = 0, height = 0;
+    std::vector<uint32_t> sum;
+    std::vector<uint64_t> sumSq;
+
+    // Suma i suma kvadrata pravougaonika [x0, x1) x [y0, y1)
+    void box(int x0, int y0, int x1, int y1, uint32_t& s, uint64_t& s2) const {
+        const int w = width + 1;
+        s = sum[y1 * w + x1] - sum[y0 * w + x1] - sum[y1 * w + x0] + sum[y0 * w + x0];
+        s2 = sumSq[y1 * w + x1] - sumSq[y0 * w + x1] - sumSq[y1 * w + x0] + sumSq[y0 * w + x0];
     }
+};
 
-    return { topLeft, topRight, bottomRight, bottomLeft };
+// Red integralne slike = prefiks sume reda + red iznad; sabiranje sa redom iznad je vektorsko
+void integral_add_row_scalar(const uint32_t* prefix, const uint64_t* prefixSq, const uint32_t* above,
+                             const uint64_t* aboveSq, uint32_t* out, uint64_t* outSq, int n) {
+    for (int x = 0; x < n; ++x) {
+        out[x] = prefix[x] + above[x];
+        outSq[x] = prefixSq[x] + aboveSq[x];
+    }
 }
 
-std::vector<unsigned char> binarize_image(const std::vector<unsigned char>& gray, int width, int height, int threshold) {
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void integral_add_row_avx2(const uint32_t* prefix, const uint64_t* prefixSq, const uint32_t* above,
+                           const uint64_t* aboveSq, uint32_t* out, uint64_t* outSq, int n) {
+    int x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(prefix + x));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(above + x));
+        _mm256_storeu_si256((__m256i*)(out + x), _mm256_add_epi32(a, b));
+        for (int k = 0; k < 8; k += 4) {
+            __m256i c = _mm256_loadu_si256((const __m256i*)(prefixSq + x + k));
+            __m256i d = _mm256_loadu_si256((const __m256i*)(aboveSq + x + k));
+            _mm256_storeu_si256((__m256i*)(outSq + x + k), _mm256_add_epi64(c, d));
+        }
+    }
+    integral_add_row_scalar(prefix + x, prefixSq + x, above + x, aboveSq + x, out + x, outSq + x, n - x);
+}
+#else
+void integral_add_row_avx2(const uint32_t* prefix, const uint64_t* prefixSq, const uint32_t* above,
+                           const uint64_t* aboveSq, uint32_t* out, uint64_t* outSq, int n) {
+    integral_add_row_scalar(prefix, prefixSq, above, aboveSq, out, outSq, n);
+}
+#endif
+
+// Suma i suma kvadrata u jednom prolazu kroz ravan (uint32 suma je dovoljna do 16M piksela)
+IntegralImage integral_image(const unsigned char* gray, int width, int height, int stride) {
+    IntegralImage ii;
+    ii.width = width;
+    ii.height = height;
+    const int w = width + 1;
+    ii.sum.assign((size_t)w * (height + 1), 0);
+    ii.sumSq.assign((size_t)w * (height + 1), 0);
+    auto addRow = cpu_has_avx2() ? integral_add_row_avx2 : integral_add_row_scalar;
+    std::vector<uint32_t> prefix(w, 0);
+    std::vector<uint64_t> prefixSq(w, 0);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = gray + (size_t)y * stride;
+        uint32_t s = 0;
+        uint64_t s2 = 0;
+        for (int x = 0; x < width; ++x) {
+            s += row[x];
+            s2 += (uint32_t)row[x] * row[x];
+            prefix[x + 1] = s;
+            prefixSq[x + 1] = s2;
+        }
+        addRow(prefix.data(), prefixSq.data(), &ii.sum[(size_t)y * w], &ii.sumSq[(size_t)y * w],
+               &ii.sum[(size_t)(y + 1) * w], &ii.sumSq[(size_t)(y + 1) * w], w);
+    }
+    return ii;
+}
+
+// Lokalni prag u prozoru window x window oko svakog piksela (odsječen na ivicama slike).
+// Kao binarize_plane: svjetliji od praga = 255. U ravnim prozorima se koristi fixedThreshold.
+std::vector<unsigned char> binarize_adaptive(const unsigned char* gray, int width, int height, int stride,
+                                             ThresholdMode mode, int window, int fixedThreshold) {
+    IntegralImage ii = integral_image(gray, width, height, stride);
     std::vector<unsigned char> binary(width * height);
-    for (int i = 0; i < width * height; ++i)
-        binary[i] = (gray[i] > threshold) ? 255 : 0;
+    const int r = std::max(1, window / 2), w = width + 1;
+    const int64_t minVar = (int64_t)(ADAPTIVE_MIN_STD * ADAPTIVE_MIN_STD);
+    const int64_t bradley = (int64_t)std::lround((1.0f - BRADLEY_T) * 1024);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = gray + (size_t)y * stride;
+        int y0 = std::max(0, y - r), y1 = std::min(height, y + r + 1);
+        const uint32_t *s0 = &ii.sum[(size_t)y0 * w], *s1 = &ii.sum[(size_t)y1 * w];
+        const uint64_t *q0 = &ii.sumSq[(size_t)y0 * w], *q1 = &ii.sumSq[(size_t)y1 * w];
+        unsigned char* out = &binary[(size_t)y * width];
+        for (int x = 0; x < width; ++x) {
+            int x0 = std::max(0, x - r), x1 = std::min(width, x + r + 1);
+            // Cjelobrojno: n * var = n * s2 - s^2, piksel poređen sa s / n bez dijeljenja
+            int64_t n = (int64_t)(x1 - x0) * (y1 - y0);
+            int64_t s = (int64_t)(s1[x1] - s0[x1] - s1[x0] + s0[x0]);
+            int64_t s2 = (int64_t)(q1[x1] - q0[x1] - q1[x0] + q0[x0]);
+            int64_t nVar = n * s2 - s * s;    // n^2 * varijansa
+            bool bright;
+            if (nVar < minVar * n * n) {
+                bright = row[x] > fixedThreshold;
+            } else if (mode == ThresholdMode::Sauvola) {
+                float mean = (float)s / n, sd = std::sqrt((float)nVar) / n;
+                bright = row[x] > mean * (1.0f + SAUVOLA_K * (sd / SAUVOLA_R - 1.0f));
+            } else {
+                bright = (int64_t)row[x] * n * 1024 > s * bradley;
+            }
+            out[x] = bright ? 255 : 0;
+        }
+    }
     return binary;
 }
 
+// Jedan prag za cijelu ravan (Fixed i Otsu); hist je histogram iz konverzije u grayscale,
+// bez njega se za Otsu računa posebnim prolazom
+int global_threshold(const unsigned char* gray, int width, int height, int stride, ThresholdMode mode,
+                     int fixedThreshold, const GrayHistogram* hist) {
+    if (mode != ThresholdMode::Otsu) return fixedThreshold;
+    GrayHistogram own;
+    if (!hist) {
+        gray_plane_histogram(gray, stride, false, width, height, nullptr, &own);
+        hist = &own;
+    }
+    int threshold = otsu_threshold(*hist, fixedThreshold);
+    LOG_DEBUG("Otsu prag %dx%d: %d", width, height, threshold);
+    return threshold;
+}
+
+bool is_global_threshold(ThresholdMode mode) {
+    return mode == ThresholdMode::Fixed || mode == ThresholdMode::Otsu;
+}
+
+// Binarizacija izabranim pragom; window se koristi samo za adaptivne, a hist samo za Otsu
+std::vector<unsigned char> threshold_plane(const unsigned char* gray, int width, int height, int stride,
+                                           ThresholdMode mode, int window, int fixedThreshold,
+                                           const GrayHistogram* hist = nullptr) {
+    if (is_global_threshold(mode))
+        return binarize_plane(gray, width, height, stride,
+                              global_threshold(gray, width, height, stride, mode, fixedThreshold, hist));
+    return binarize_adaptive(gray, width, height, stride, mode, window, fixedThreshold);
+}
+
 std::vector<Point2f> find_largest_component(const std::vector<unsigned char>& binary, int width, int height) {
     std::vector<bool> visited(width * height, false);
     std::vector<Point2f> largest;
@@ -131,55 +954,1035 @@ std::vector<Point2f> find_largest_component(const std::vector<unsigned char>& bi
     return largest;
 }
 
+// ---------------------------------------------------------------------------
+// Zamućenje i morfologija (GaussianBlur 5x5 i erode/dilate iz OpenCV/BVPoker.cpp):
+// Gauss je separabilan u fiksnom zarezu, a morfologija radi nad bit-pakovanim
+// redovima, 64 piksela po riječi
+// ---------------------------------------------------------------------------
 
+// Gauss 5 tačaka, sigma 1, u Q8 (zbir 256): u 16 bita staje 255 * 256 bez prelivanja
+const int GAUSS_W0 = 104, GAUSS_W1 = 62, GAUSS_W2 = 14;
 
-
-
-void save_image(const std::string& filename, const std::vector<unsigned char>& image, int width, int height) {
-    stbi_write_png(filename.c_str(), width, height, 3, image.data(), width * 3);
+// Horizontalni prolaz za x iz [x0, x1); susjedi van reda se ponavljaju sa ivice
+void gauss_row_range(const unsigned char* src, int width, int x0, int x1, unsigned char* dst) {
+    for (int x = x0; x < x1; ++x) {
+        auto p = [&](int dx) { return (int)src[std::clamp(x + dx, 0, width - 1)]; };
+        dst[x] = (unsigned char)((GAUSS_W0 * p(0) + GAUSS_W1 * (p(-1) + p(1)) + GAUSS_W2 * (p(-2) + p(2)) + 128) >> 8);
+    }
 }
 
-std::vector<unsigned char> warp_image(const unsigned char* input, int srcW, int srcH, std::array<Point2f, 4> corners, int dstW, int dstH) {
-    std::vector<unsigned char> output(dstW * dstH * 3);
-
-    for (int y = 0; y < dstH; ++y) {
-        float v = y / (float)(dstH - 1);
-        for (int x = 0; x < dstW; ++x) {
-            float u = x / (float)(dstW - 1);
+void gauss_row_scalar(const unsigned char* src, int width, unsigned char* dst) {
+    gauss_row_range(src, width, 0, width, dst);
+}
 
-            Point2f top = {
-                (1 - u) * corners[0].x + u * corners[1].x,
-                (1 - u) * corners[0].y + u * corners[1].y
-            };
-            Point2f bottom = {
-                (1 - u) * corners[3].x + u * corners[2].x,
-                (1 - u) * corners[3].y + u * corners[2].y
-            };
-            Point2f p = {
-                (1 - v) * top.x + v * bottom.x,
-                (1 - v) * top.y + v * bottom.y
-            };
+// Vertikalni prolaz: red iz pet susjednih redova
+void gauss_col_scalar(const unsigned char* const* rows, int width, unsigned char* dst) {
+    for (int x = 0; x < width; ++x)
+        dst[x] = (unsigned char)((GAUSS_W0 * rows[2][x] + GAUSS_W1 * (rows[1][x] + rows[3][x]) +
+                                  GAUSS_W2 * (rows[0][x] + rows[4][x]) + 128) >> 8);
+}
 
-            int px = std::clamp((int)p.x, 0, srcW - 1);
-            int py = std::clamp((int)p.y, 0, srcH - 1);
-            for (int c = 0; c < 3; ++c)
-                output[(y * dstW + x) * 3 + c] = input[(py * srcW + px) * 3 + c];
-        }
+#if defined(__x86_64__) || defined(__i386__)
+// 16 piksela po koraku: uint8 -> uint16, množenje i sabiranje bez prelivanja, >> 8
+#define GAUSS_AVX2_16(l0, l1, l2, l3, l4)                                                          \
+    _mm256_srli_epi16(                                                                             \
+        _mm256_add_epi16(                                                                          \
+            _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(l2), w0),                     \
+                             _mm256_mullo_epi16(_mm256_add_epi16(_mm256_cvtepu8_epi16(l1),         \
+                                                                 _mm256_cvtepu8_epi16(l3)), w1)),  \
+            _mm256_add_epi16(_mm256_mullo_epi16(_mm256_add_epi16(_mm256_cvtepu8_epi16(l0),         \
+                                                                 _mm256_cvtepu8_epi16(l4)), w2),   \
+                             round)),                                                              \
+        8)
+
+__attribute__((target("avx2")))
+void gauss_row_avx2(const unsigned char* src, int width, unsigned char* dst) {
+    const __m256i w0 = _mm256_set1_epi16(GAUSS_W0), w1 = _mm256_set1_epi16(GAUSS_W1);
+    const __m256i w2 = _mm256_set1_epi16(GAUSS_W2), round = _mm256_set1_epi16(128);
+    int x = 2;
+    for (; x + 18 <= width; x += 16) {
+        __m256i v = GAUSS_AVX2_16(_mm_loadu_si128((const __m128i*)(src + x - 2)),
+                                  _mm_loadu_si128((const __m128i*)(src + x - 1)),
+                                  _mm_loadu_si128((const __m128i*)(src + x)),
+                                  _mm_loadu_si128((const __m128i*)(src + x + 1)),
+                                  _mm_loadu_si128((const __m128i*)(src + x + 2)));
+        __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storeu_si128((__m128i*)(dst + x), packed);
     }
+    gauss_row_range(src, width, 0, std::min(2, width), dst);
+    gauss_row_range(src, width, std::min(x, width), width, dst);
+}
 
-    // Flip horizontally to ensure number and symbol are in top-left
-    std::vector<unsigned char> flipped(dstW * dstH * 3);
-    for (int y = 0; y < dstH; ++y) {
-        for (int x = 0; x < dstW; ++x) {
-            for (int c = 0; c < 3; ++c) {
-                flipped[(y * dstW + x) * 3 + c] = output[(y * dstW + (dstW - 1 - x)) * 3 + c];
-            }
-        }
+__attribute__((target("avx2")))
+void gauss_col_avx2(const unsigned char* const* rows, int width, unsigned char* dst) {
+    const __m256i w0 = _mm256_set1_epi16(GAUSS_W0), w1 = _mm256_set1_epi16(GAUSS_W1);
+    const __m256i w2 = _mm256_set1_epi16(GAUSS_W2), round = _mm256_set1_epi16(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i v = GAUSS_AVX2_16(_mm_loadu_si128((const __m128i*)(rows[0] + x)),
+                                  _mm_loadu_si128((const __m128i*)(rows[1] + x)),
+                                  _mm_loadu_si128((const __m128i*)(rows[2] + x)),
+                                  _mm_loadu_si128((const __m128i*)(rows[3] + x)),
+                                  _mm_loadu_si128((const __m128i*)(rows[4] + x)));
+        __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storeu_si128((__m128i*)(dst + x), packed);
+    }
+    const unsigned char* rest[5] = {rows[0] + x, rows[1] + x, rows[2] + x, rows[3] + x, rows[4] + x};
+    gauss_col_scalar(rest, width - x, dst + x);
+}
+#undef GAUSS_AVX2_16
+#else
+void gauss_row_avx2(const unsigned char* src, int width, unsigned char* dst) {
+    gauss_row_scalar(src, width, dst);
+}
+void gauss_col_avx2(const unsigned char* const* rows, int width, unsigned char* dst) {
+    gauss_col_scalar(rows, width, dst);
+}
+#endif
+
+// Gaussian blur 5x5 (sigma 1) redova [y0, y1); horizontalni prolaz ide u prsten od pet
+// redova, pa je međubafer 5 x width umjesto cijele slike
+void gaussian_blur_rows(const unsigned char* gray, int width, int height, int stride, int y0, int y1,
+                        unsigned char* out) {
+    const bool avx2 = cpu_has_avx2();
+    auto rowPass = avx2 ? gauss_row_avx2 : gauss_row_scalar;
+    auto colPass = avx2 ? gauss_col_avx2 : gauss_col_scalar;
+    std::vector<unsigned char> ring((size_t)5 * width);
+    auto ringRow = [&](int y) { return &ring[(size_t)((y + 5) % 5) * width]; };
+    int done = std::max(0, y0 - 2);   // prvi red koji još nije prošao horizontalni prolaz
+    for (int y = y0; y < y1; ++y) {
+        for (; done < std::min(height, y + 3); ++done) rowPass(gray + (size_t)done * stride, width, ringRow(done));
+        const unsigned char* rows[5];
+        for (int k = 0; k < 5; ++k) rows[k] = ringRow(std::clamp(y + k - 2, 0, height - 1));
+        colPass(rows, width, out + (size_t)y * width);
     }
-    return flipped;
 }
 
-void save_top_left_corner(const std::vector<unsigned char>& image, int width, int height, int cornerW, int cornerH, const std::string& filename) {
+// Cijela ravan; veliki frejmovi se kao gray_plane_histogram dijele na trake (BandPool)
+std::vector<unsigned char> gaussian_blur_plane(const unsigned char* gray, int width, int height, int stride) {
+    std::vector<unsigned char> out((size_t)width * height);
+    if (width == 0 || height == 0) return out;
+    BandPool& pool = BandPool::instance();
+    int threads = pool.bands((int64_t)width * height);
+    pool.run(threads, [&](int t) {
+        gaussian_blur_rows(gray, width, height, stride, height * t / threads, height * (t + 1) / threads,
+                           out.data());
+    });
+    return out;
+}
+
+// Binarna slika sa 64 piksela po riječi; bit x % 64 riječi x / 64 je piksel x
+struct BitPlane {
+    int width = 0, height = 0, words = 0;
+    std::vector<uint64_t> bits;
+    uint64_t* row(int y) { return &bits[(size_t)y * words]; }
+    const uint64_t* row(int y) const { return &bits[(size_t)y * words]; }
+};
+
+// Pakovanje reda uz prag: bit je 1 za piksel > threshold. Sa AVX2 se poredi 32 bajta
+// odjednom (bez znaka, preko xor 0x80), a movemask daje 32 bita.
+void pack_row_scalar(const unsigned char* src, int width, int threshold, uint64_t* dst) {
+    for (int x = 0; x < width; ++x)
+        if (src[x] > threshold) dst[x / 64] |= 1ull << (x % 64);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void pack_row_avx2(const unsigned char* src, int width, int threshold, uint64_t* dst) {
+    const __m256i bias = _mm256_set1_epi8((char)0x80), t = _mm256_set1_epi8((char)(threshold ^ 0x80));
+    int x = 0;
+    for (; x + 64 <= width; x += 64) {
+        __m256i a = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(src + x)), bias);
+        __m256i b = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(src + x + 32)), bias);
+        uint32_t lo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(a, t));
+        uint32_t hi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(b, t));
+        dst[x / 64] = lo | (uint64_t)hi << 32;
+    }
+    pack_row_scalar(src + x, width - x, threshold, dst + x / 64);
+}
+#else
+void pack_row_avx2(const unsigned char* src, int width, int threshold, uint64_t* dst) {
+    pack_row_scalar(src, width, threshold, dst);
+}
+#endif
+
+// Sivu ili binarnu (threshold 0) ravan pakuje u bitove
+BitPlane pack_plane(const unsigned char* src, int width, int height, int stride, int threshold) {
+    BitPlane bp{width, height, (width + 63) / 64, {}};
+    bp.bits.assign((size_t)bp.words * height, 0);
+    auto packRow = cpu_has_avx2() ? pack_row_avx2 : pack_row_scalar;
+    for (int y = 0; y < height; ++y) packRow(src + (size_t)y * stride, width, threshold, bp.row(y));
+    return bp;
+}
+
+// Binarizacija direktno u bitove: globalni prag bez međukoraka u bajtovima
+BitPlane threshold_bits(const unsigned char* gray, int width, int height, int stride, ThresholdMode mode,
+                        int window, int fixedThreshold, const GrayHistogram* hist = nullptr) {
+    if (is_global_threshold(mode))
+        return pack_plane(gray, width, height, stride,
+                          global_threshold(gray, width, height, stride, mode, fixedThreshold, hist));
+    auto binary = binarize_adaptive(gray, width, height, stride, mode, window, fixedThreshold);
+    return pack_plane(binary.data(), width, height, width, 0);
+}
+
+// Raspakivanje po 8 piksela preko tabele bajt -> osam bajtova 0/255
+void unpack_binary(const BitPlane& bp, std::vector<unsigned char>& binary) {
+    static const auto table = [] {
+        std::array<uint64_t, 256> t;
+        for (int b = 0; b < 256; ++b) {
+            t[b] = 0;
+            for (int i = 0; i < 8; ++i)
+                if (b >> i & 1) t[b] |= 0xFFull << (8 * i);
+        }
+        return t;
+    }();
+    binary.resize((size_t)bp.width * bp.height);
+    for (int y = 0; y < bp.height; ++y) {
+        const uint64_t* src = bp.row(y);
+        unsigned char* dst = &binary[(size_t)y * bp.width];
+        int x = 0;
+        for (; x + 8 <= bp.width; x += 8) memcpy(dst + x, &table[(src[x / 64] >> (x % 64)) & 0xFF], 8);
+        for (; x < bp.width; ++x) dst[x] = (src[x / 64] >> (x % 64)) & 1 ? 255 : 0;
+    }
+}
+
+// Jedan prolaz 3x3 (kao erode/dilate sa Mat() u OpenCV-u): susjedi lijevo i desno su
+// šiftovi riječi sa prenosom iz susjedne riječi, a gore i dolje su susjedni redovi.
+// Van slike je za erode sve bijelo, a za dilate sve crno, pa ivica slike ne mijenja rezultat.
+void morph_bits(const BitPlane& src, BitPlane& dst, bool erode) {
+    const int words = src.words, width = src.width, height = src.height;
+    const uint64_t outside = erode ? ~0ull : 0;
+    const int tail = width % 64;
+    const uint64_t tailMask = tail ? (1ull << tail) - 1 : ~0ull;
+    dst = {width, height, words, std::vector<uint64_t>(src.bits.size())};
+    // Red sa po jednom riječju "van slike" sa obje strane, pa petlja nema grananja
+    std::vector<uint64_t> pad(words + 2, outside);
+    std::vector<uint64_t> horiz((size_t)3 * words);   // horizontalni rezultat redova y-1, y, y+1
+    auto horizontal = [&](int y, uint64_t* h) {
+        if (y < 0 || y >= height) {
+            std::fill(h, h + words, outside);
+            return;
+        }
+        std::copy(src.row(y), src.row(y) + words, &pad[1]);
+        pad[words] = erode ? (pad[words] | ~tailMask) : (pad[words] & tailMask);
+        for (int k = 0; k < words; ++k) {
+            uint64_t prev = pad[k], cur = pad[k + 1], next = pad[k + 2];
+            uint64_t left = (cur << 1) | (prev >> 63), right = (cur >> 1) | (next << 63);
+            h[k] = erode ? (cur & left & right) : (cur | left | right);
+        }
+    };
+    uint64_t* h0 = &horiz[0];
+    uint64_t* h1 = &horiz[words];
+    uint64_t* h2 = &horiz[(size_t)2 * words];
+    horizontal(-1, h0);
+    horizontal(0, h1);
+    for (int y = 0; y < height; ++y) {
+        horizontal(y + 1, h2);
+        uint64_t* out = dst.row(y);
+        for (int k = 0; k < words; ++k) out[k] = erode ? (h0[k] & h1[k] & h2[k]) : (h0[k] | h1[k] | h2[k]);
+        out[words - 1] &= tailMask;
+        std::swap(h0, h1);
+        std::swap(h1, h2);
+    }
+}
+
+void erode_bits(const BitPlane& src, BitPlane& dst) { morph_bits(src, dst, true); }
+void dilate_bits(const BitPlane& src, BitPlane& dst) { morph_bits(src, dst, false); }
+
+// Otvaranje briše bijele tačke manje od 3x3, zatvaranje popunjava takve rupe
+void open_bits(BitPlane& img) {
+    BitPlane tmp;
+    erode_bits(img, tmp);
+    dilate_bits(tmp, img);
+}
+
+void close_bits(BitPlane& img) {
+    BitPlane tmp;
+    dilate_bits(img, tmp);
+    erode_bits(tmp, img);
+}
+
+// ---------------------------------------------------------------------------
+// Praćenje ivica (Suzuki-Abe) i Douglas-Peucker: za lokalizaciju karte se čuvaju
+// samo konture, pa posao i memorija rastu sa obimom karte umjesto sa površinom
+// ---------------------------------------------------------------------------
+
+// Oznake koje praćenje upisuje u binarnu sliku (255 = objekat, 0 = pozadina)
+const unsigned char CONTOUR_SEEN = 2;       // piksel obiđene ivice
+const unsigned char CONTOUR_SEEN_EAST = 3;  // piksel ivice sa pozadinom desno (-NBD kod Suzukija)
+
+// 8 susjeda redom suprotno od kazaljke na satu (y raste nadolje): E, NE, N, NW, W, SW, S, SE
+const int CONTOUR_DX[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+const int CONTOUR_DY[8] = {0, -1, -1, -1, 0, 1, 1, 1};
+
+// Obilazi ivicu od (x, y) (8-povezanost); from je smjer susjeda iz pozadine kojim je ivica
+// pronađena (W za spoljnu, E za rupu). Tačke se upisuju u points, osim kad je nullptr.
+void trace_border(std::vector<unsigned char>& img, int width, int height, int x, int y, int from,
+                  std::vector<Point2f>* points) {
+    auto at = [&](int px, int py) -> unsigned char {
+        return (px >= 0 && py >= 0 && px < width && py < height) ? img[(size_t)py * width + px] : 0;
+    };
+    // Prvi objekat u smjeru kazaljke od from je posljednji piksel obilaska
+    int last = -1;
+    for (int k = 1; k <= 8 && last < 0; ++k) {
+        int d = (from - k + 8) & 7;
+        if (at(x + CONTOUR_DX[d], y + CONTOUR_DY[d])) last = d;
+    }
+    if (last < 0) {
+        img[(size_t)y * width + x] = CONTOUR_SEEN_EAST; // izolovan piksel
+        if (points) points->push_back({(float)x, (float)y});
+        return;
+    }
+    const int lastX = x + CONTOUR_DX[last], lastY = y + CONTOUR_DY[last];
+    int cx = x, cy = y, back = last;
+    while (true) {
+        // Sljedeći objekat suprotno od kazaljke, počev iza piksela iz kog smo došli
+        bool eastBackground = false;
+        int d = back, nx, ny;
+        do {
+            d = (d + 1) & 7;
+            nx = cx + CONTOUR_DX[d];
+            ny = cy + CONTOUR_DY[d];
+            if (at(nx, ny)) break;
+            if (d == 0) eastBackground = true;
+        } while (d != back);
+        unsigned char& f = img[(size_t)cy * width + cx];
+        if (eastBackground) f = CONTOUR_SEEN_EAST;
+        else if (f == 255) f = CONTOUR_SEEN;
+        if (points) points->push_back({(float)cx, (float)cy});
+        if (nx == x && ny == y && cx == lastX && cy == lastY) break;
+        back = (d + 4) & 7;
+        cx = nx;
+        cy = ny;
+    }
+}
+
+// Površina poligona (shoelace); negativna kad je obilazak suprotno od kazaljke na ekranu
+float signed_area(const std::vector<Point2f>& poly) {
+    double a = 0;
+    for (size_t i = 0, n = poly.size(); i < n; ++i) {
+        const Point2f &p = poly[i], &q = poly[(i + 1) % n];
+        a += (double)p.x * q.y - (double)q.x * p.y;
+    }
+    return (float)(a / 2);
+}
+
+// Spoljna kontura najveće površine među objektima (255) binarne slike. Slika se mijenja:
+// pikseli ivica dobijaju CONTOUR_SEEN oznake. Rupe se obilaze samo da bi se označile.
+std::vector<Point2f> find_largest_contour(std::vector<unsigned char>& img, int width, int height) {
+    std::vector<Point2f> largest, contour;
+    float largestArea = 0;
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = &img[(size_t)y * width];
+        for (int x = 0; x < width; ++x) {
+            unsigned char v = row[x];
+            if (v == 0 || v == CONTOUR_SEEN_EAST) continue;
+            if (v == 255 && (x == 0 || row[x - 1] == 0)) {
+                contour.clear();
+                trace_border(img, width, height, x, y, 4, &contour);
+                float area = std::fabs(signed_area(contour));
+                if (largest.empty() || area > largestArea) {
+                    largestArea = area;
+                    largest.swap(contour);
+                }
+            } else if (x + 1 == width || row[x + 1] == 0) {
+                trace_border(img, width, height, x, y, 0, nullptr);
+            }
+        }
+    }
+    return largest;
+}
+
+// Udaljenost tačke p od prave kroz a i b
+float line_distance(Point2f p, Point2f a, Point2f b) {
+    float dx = b.x - a.x, dy = b.y - a.y, len = std::sqrt(dx * dx + dy * dy);
+    if (len < 1e-6f) return distance(p, a);
+    return std::fabs(dy * (p.x - a.x) - dx * (p.y - a.y)) / len;
+}
+
+// Douglas-Peucker nad zatvorenom konturom: temena poligona koji nigdje ne odstupa od
+// konture više od epsilon, redom kao u konturi. Kontura se prvo dijeli na dva lanca
+// između (približno) najudaljenijih tačaka; lanci se dijele bez rekurzije.
+std::vector<Point2f> approx_polygon(const std::vector<Point2f>& contour, float epsilon) {
+    const size_t n = contour.size();
+    if (n < 4) return contour;
+    auto farthest = [&](size_t from) {
+        size_t best = from;
+        float bestD = -1;
+        for (size_t i = 0; i < n; ++i) {
+            float d = distance(contour[i], contour[from]);
+            if (d > bestD) { bestD = d; best = i; }
+        }
+        return best;
+    };
+    size_t a = farthest(0), b = farthest(a);
+    if (a > b) std::swap(a, b);
+    std::vector<char> keep(n, 0);
+    keep[a] = keep[b] = 1;
+    std::vector<std::pair<size_t, size_t>> stack = {{a, b}, {b, a + n}};
+    while (!stack.empty()) {
+        auto [i, j] = stack.back();
+        stack.pop_back();
+        const Point2f &p = contour[i % n], &q = contour[j % n];
+        size_t split = 0;
+        float maxD = epsilon;
+        for (size_t k = i + 1; k < j; ++k) {
+            float d = line_distance(contour[k % n], p, q);
+            if (d > maxD) { maxD = d; split = k; }
+        }
+        if (split == 0) continue;
+        keep[split % n] = 1;
+        stack.push_back({i, split});
+        stack.push_back({split, j});
+    }
+    std::vector<Point2f> poly;
+    for (size_t i = 0; i < n; ++i)
+        if (keep[i]) poly.push_back(contour[i]);
+    return poly;
+}
+
+// Četiri temena redom po obodu -> isti redoslijed kao find_corners: od gornjeg lijevog,
+// suprotno od kazaljke na ekranu
+std::array<Point2f, 4> quad_corners(std::vector<Point2f> quad) {
+    if (signed_area(quad) > 0) std::reverse(quad.begin(), quad.end());
+    size_t first = 0;
+    for (size_t i = 1; i < 4; ++i)
+        if (quad[i].x + quad[i].y < quad[first].x + quad[first].y) first = i;
+    std::rotate(quad.begin(), quad.begin() + first, quad.end());
+    return orient_corners(quad[0], quad[1], quad[2], quad[3]);
+}
+
+// Do ovog nagiba se uzimaju ekstremi x+y / x-y konture; iznad njega dva ekstrema padaju
+// u isti ugao karte, pa se koriste temena četvorougla
+const float EXTREMA_MAX_TILT_DEG = 30.0f;
+
+// Nagib četvorougla u stepenima, sveden na [-45, 45): uglovi stranica se množe sa 4,
+// pa se sve četiri stranice sabiraju u isti smjer (težina je dužina stranice)
+float quad_tilt(const std::vector<Point2f>& quad) {
+    double c = 0, s = 0;
+    for (size_t i = 0, n = quad.size(); i < n; ++i) {
+        const Point2f &p = quad[i], &q = quad[(i + 1) % n];
+        double a = std::atan2(q.y - p.y, q.x - p.x), len = distance(p, q);
+        c += len * std::cos(4 * a);
+        s += len * std::sin(4 * a);
+    }
+    return (float)(std::atan2(s, c) / 4 * 180 / M_PI);
+}
+
+// Redoslijed kojim bi pretraga u širinu iz seed (susjedi +x, -x, +y, -y) posjetila p
+// u konveksnoj oblasti: udaljenost, pa strana i pomak po x, pa strana po y
+std::array<int, 4> flood_order(Point2f seed, Point2f p) {
+    int dx = (int)p.x - (int)seed.x, dy = (int)p.y - (int)seed.y;
+    return {std::abs(dx) + std::abs(dy), dx > 0 ? 0 : dx < 0 ? 1 : 2, -std::abs(dx), dy < 0};
+}
+
+// find_corners nad konturom: kontura počinje prvim pikselom karte u rasteru, od kog je
+// punjenje u find_largest_component kretalo, pa se jednaki ekstremi (kosi niz piksela
+// na zaobljenom uglu) biraju po redoslijedu tog punjenja. Uglovi su tako isti kao kad
+// su se ekstremi tražili nad svim pikselima karte, a na njih su podešeni šabloni.
+std::array<Point2f, 4> contour_extrema(const std::vector<Point2f>& contour) {
+    const Point2f seed = contour[0];
+    Point2f corner[4] = {seed, seed, seed, seed};  // min x+y, max x+y, min x-y, max x-y
+    float best[4] = {1e9, -1e9, 1e9, -1e9};
+    for (const auto& p : contour) {
+        const float value[4] = {p.x + p.y, p.x + p.y, p.x - p.y, p.x - p.y};
+        for (int k = 0; k < 4; ++k) {
+            bool better = k % 2 ? value[k] > best[k] : value[k] < best[k];
+            if (better || (value[k] == best[k] && flood_order(seed, p) < flood_order(seed, corner[k]))) {
+                best[k] = value[k];
+                corner[k] = p;
+            }
+        }
+    }
+    return orient_corners(corner[0], corner[2], corner[1], corner[3]);
+}
+
+// Konveksni omotač (monotoni lanac, O(n log n)); temena redom sa pozitivnom površinom
+// po signed_area, kolinearne tačke se izbacuju
+std::vector<Point2f> convex_hull(std::vector<Point2f> points) {
+    std::sort(points.begin(), points.end(),
+              [](Point2f a, Point2f b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+    points.erase(std::unique(points.begin(), points.end(),
+                             [](Point2f a, Point2f b) { return a.x == b.x && a.y == b.y; }),
+                 points.end());
+    if (points.size() < 3) return points;
+    auto cross = [](Point2f o, Point2f a, Point2f b) {
+        return (double)(a.x - o.x) * (b.y - o.y) - (double)(a.y - o.y) * (b.x - o.x);
+    };
+    std::vector<Point2f> hull(2 * points.size());
+    size_t k = 0;
+    for (size_t i = 0; i < points.size(); ++i) {              // donji lanac
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) --k;
+        hull[k++] = points[i];
+    }
+    for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;) { // gornji lanac
+        while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) --k;
+        hull[k++] = points[i];
+    }
+    hull.resize(k - 1);   // posljednja tačka je ponovo prva
+    return hull;
+}
+
+// Pravougaonik najmanje površine oko konveksnog omotača (rotirajući šestari): jedna
+// stranica leži na nekoj ivici omotača, a tri oslonca se za svaku ivicu samo pomjeraju
+// naprijed, pa je cijela pretraga O(h). Vraća uglove redom po obodu.
+std::array<Point2f, 4> min_area_rect(const std::vector<Point2f>& hull) {
+    const size_t h = hull.size();
+    if (h < 3) {
+        Point2f a = hull.empty() ? Point2f{0, 0} : hull.front(), b = hull.empty() ? a : hull.back();
+        return {a, b, b, a};
+    }
+    auto dot = [](Point2f p, float ux, float uy) { return p.x * ux + p.y * uy; };
+    double bestArea = -1;
+    std::array<Point2f, 4> best{};
+    size_t right = 0, top = 0, left = 0;   // indeksi rastu, temena su hull[idx % h]
+    for (size_t i = 0; i < h; ++i) {
+        const Point2f p = hull[i], q = hull[(i + 1) % h];
+        float len = distance(p, q);
+        const float ux = (q.x - p.x) / len, uy = (q.y - p.y) / len;  // smjer ivice
+        const float nx = -uy, ny = ux;                              // normala prema unutra
+        right = std::max(right, i + 1);
+        while (dot(hull[(right + 1) % h], ux, uy) > dot(hull[right % h], ux, uy)) ++right;
+        top = std::max(top, right);
+        while (dot(hull[(top + 1) % h], nx, ny) > dot(hull[top % h], nx, ny)) ++top;
+        left = std::max(left, top);
+        while (dot(hull[(left + 1) % h], ux, uy) < dot(hull[left % h], ux, uy)) ++left;
+        float base = dot(p, ux, uy), off = dot(p, nx, ny);
+        float maxU = dot(hull[right % h], ux, uy) - base, minU = dot(hull[left % h], ux, uy) - base;
+        float maxN = dot(hull[top % h], nx, ny) - off;
+        double area = (double)(maxU - minU) * maxN;
+        if (bestArea < 0 || area < bestArea) {
+            bestArea = area;
+            auto at = [&](float u, float n) { return Point2f{p.x + u * ux + n * nx, p.y + u * uy + n * ny}; };
+            best = {at(minU, 0), at(maxU, 0), at(maxU, maxN), at(minU, maxN)};
+        }
+    }
+    return best;
+}
+
+// Uglovi karte kao u OpenCV varijanti (convexHull + minAreaRect): uglovi pravougaonika
+// najmanje površine oko omotača konture, svaki privučen najbližem temenu omotača, pa
+// prate i nagnutu kartu i perspektivu, a zaobljeni uglovi ne smetaju. Pravougaonik
+// nagnut do EXTREMA_MAX_TILT_DEG daje ekstreme konture.
+std::array<Point2f, 4> hull_corners(const std::vector<Point2f>& contour) {
+    std::vector<Point2f> hull = convex_hull(contour);
+    if (hull.size() < 4) return contour_extrema(contour);
+    auto rect = min_area_rect(hull);
+    if (std::fabs(quad_tilt({rect.begin(), rect.end()})) <= EXTREMA_MAX_TILT_DEG) return contour_extrema(contour);
+    std::vector<Point2f> quad(4);
+    for (int j = 0; j < 4; ++j) {
+        float bestD = -1;
+        for (const auto& p : hull) {
+            float d = distance(p, rect[j]);
+            if (bestD < 0 || d < bestD) { bestD = d; quad[j] = p; }
+        }
+    }
+    return quad_corners(quad);
+}
+
+// Uglovi karte iz njene konture: Douglas-Peucker sa 2% obima. Temena četvorougla su
+// uglovi samo za kartu nagnutu više od EXTREMA_MAX_TILT_DEG; inače, i kad to nije
+// četvorougao (zaklonjen ugao, karta na ivici kadra), uzimaju se ekstremi konture.
+std::array<Point2f, 4> contour_corners(const std::vector<Point2f>& contour) {
+    float perimeter = 0;
+    for (size_t i = 0, n = contour.size(); i < n; ++i) perimeter += distance(contour[i], contour[(i + 1) % n]);
+    std::vector<Point2f> quad = approx_polygon(contour, 0.02f * perimeter);
+    if (quad.size() != 4) {
+        LOG_DEBUG("Aproksimacija konture ima %zu temena, koriste se ekstremi", quad.size());
+        return contour_extrema(contour);
+    }
+    if (std::fabs(quad_tilt(quad)) <= EXTREMA_MAX_TILT_DEG) return contour_extrema(contour);
+    return quad_corners(quad);
+}
+
+// Način traženja uglova karte na konturi (--corners)
+enum class CornerMethod { Hull, Poly, Extrema };
+
+std::array<Point2f, 4> card_corners(const std::vector<Point2f>& contour, CornerMethod method) {
+    switch (method) {
+        case CornerMethod::Poly: return contour_corners(contour);
+        case CornerMethod::Extrema: return contour_extrema(contour);
+        default: return hull_corners(contour);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Lokalizacija po ivicama: Canny nad umanjenim frejmom, Houghova transformacija
+// u kojoj piksel glasa samo za uglove blizu smjera svog gradijenta, i presjeci
+// četiri dominantne prave. Ne traži da karta bude najveća svijetla mrlja, pa radi
+// i na svijetlom stolu i kad se karte preklapaju.
+// ---------------------------------------------------------------------------
+
+enum class Localizer { Blob, Edges };
+
+const int EDGE_MAX_DIM = 512;             // duža strana umanjenog frejma
+const int EDGE_MAX_SCALE = 16;            // suma bloka s x s staje u uint16
+const int EDGE_MIN_HIGH = 48;             // najmanji gornji prag Canny-ja (|gx| + |gy|)
+const float EDGE_HIGH_QUANTILE = 0.90f;   // gornji prag: 90. percentil jačine gradijenta
+const int HOUGH_SPREAD = 3;               // piksel glasa za uglove do 3° od smjera gradijenta
+const int HOUGH_PEAKS = 16;
+const float HOUGH_MIN_DTHETA = 5.0f, HOUGH_MIN_DRHO = 8.0f; // razmak izabranih prava
+const float EDGE_PARALLEL_DEG = 20.0f;    // naspramne stranice (perspektiva ih razmiče)
+const float EDGE_MIN_CORNER_DEG = 50.0f;  // ugao između susjednih stranica
+const float EDGE_MIN_ASPECT = 0.5f, EDGE_MAX_ASPECT = 0.95f; // karta je 2.5 x 3.5
+const float EDGE_MIN_COVERAGE = 0.6f;     // dio stranice koji mora ležati na ivici
+const int REFINE_ITERATIONS = 3;
+const float REFINE_MIN_COS = 0.97f;       // gradijent tačke do ~14° od normale prave
+
+// Umanjenje sive ravni s puta (prosjek bloka s x s); ostatak na desnoj i donjoj ivici se
+// odbacuje. Redovi bloka se prvo sabiraju po kolonama, pa se suma dijeli po blokovima.
+std::vector<unsigned char> downscale_plane(const unsigned char* gray, int width, int height, int stride, int s,
+                                           int& outW, int& outH) {
+    outW = width / s;
+    outH = height / s;
+    std::vector<unsigned char> out((size_t)outW * outH);
+    std::vector<uint16_t> cols((size_t)outW * s);
+    const uint32_t div = s * s;
+    for (int y = 0; y < outH; ++y) {
+        std::fill(cols.begin(), cols.end(), 0);
+        for (int k = 0; k < s; ++k) {
+            const unsigned char* row = gray + (size_t)(y * s + k) * stride;
+            for (size_t x = 0; x < cols.size(); ++x) cols[x] += row[x];
+        }
+        for (int x = 0; x < outW; ++x) {
+            uint32_t sum = 0;
+            for (int k = 0; k < s; ++k) sum += cols[x * s + k];
+            out[(size_t)y * outW + x] = (unsigned char)((sum + div / 2) / div);
+        }
+    }
+    return out;
+}
+
+// Sobel za red y (x = 1 .. width - 2) iz redova iznad, istog i ispod: gx, gy i |gx| + |gy|
+void sobel_row_scalar(const unsigned char* r0, const unsigned char* r1, const unsigned char* r2, int x0, int width,
+                      int16_t* gx, int16_t* gy, int16_t* mag) {
+    for (int x = x0; x < width - 1; ++x) {
+        int dx = (r0[x + 1] - r0[x - 1]) + 2 * (r1[x + 1] - r1[x - 1]) + (r2[x + 1] - r2[x - 1]);
+        int dy = (r2[x - 1] + 2 * r2[x] + r2[x + 1]) - (r0[x - 1] + 2 * r0[x] + r0[x + 1]);
+        gx[x] = (int16_t)dx;
+        gy[x] = (int16_t)dy;
+        mag[x] = (int16_t)(std::abs(dx) + std::abs(dy));
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void sobel_row_avx2(const unsigned char* r0, const unsigned char* r1, const unsigned char* r2, int x0, int width,
+                    int16_t* gx, int16_t* gy, int16_t* mag) {
+#define SOBEL_LOAD(p) _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(p)))
+    int x = x0;
+    for (; x + 16 <= width - 1; x += 16) {
+        __m256i a0 = SOBEL_LOAD(r0 + x - 1), b0 = SOBEL_LOAD(r0 + x), c0 = SOBEL_LOAD(r0 + x + 1);
+        __m256i a1 = SOBEL_LOAD(r1 + x - 1), c1 = SOBEL_LOAD(r1 + x + 1);
+        __m256i a2 = SOBEL_LOAD(r2 + x - 1), b2 = SOBEL_LOAD(r2 + x), c2 = SOBEL_LOAD(r2 + x + 1);
+        __m256i d1 = _mm256_sub_epi16(c1, a1);
+        __m256i dx = _mm256_add_epi16(_mm256_add_epi16(_mm256_sub_epi16(c0, a0), _mm256_sub_epi16(c2, a2)),
+                                      _mm256_add_epi16(d1, d1));
+        __m256i dy = _mm256_add_epi16(_mm256_sub_epi16(_mm256_add_epi16(a2, c2), _mm256_add_epi16(a0, c0)),
+                                      _mm256_slli_epi16(_mm256_sub_epi16(b2, b0), 1));
+        _mm256_storeu_si256((__m256i*)(gx + x), dx);
+        _mm256_storeu_si256((__m256i*)(gy + x), dy);
+        _mm256_storeu_si256((__m256i*)(mag + x), _mm256_add_epi16(_mm256_abs_epi16(dx), _mm256_abs_epi16(dy)));
+    }
+#undef SOBEL_LOAD
+    sobel_row_scalar(r0, r1, r2, x, width, gx, gy, mag);
+}
+#else
+void sobel_row_avx2(const unsigned char* r0, const unsigned char* r1, const unsigned char* r2, int x0, int width,
+                    int16_t* gx, int16_t* gy, int16_t* mag) {
+    sobel_row_scalar(r0, r1, r2, x0, width, gx, gy, mag);
+}
+#endif
+
+struct EdgeMap {
+    int width = 0, height = 0;
+    std::vector<unsigned char> edges;   // 255 = ivica
+    std::vector<int16_t> gx, gy;
+};
+
+// Canny: Sobel, potiskivanje ne-maksimuma po smjeru gradijenta i histerezis. Gornji
+// prag je percentil jačine gradijenta (najmanje EDGE_MIN_HIGH), donji je pola gornjeg.
+void canny_edges(const unsigned char* gray, int width, int height, EdgeMap& em) {
+    em.width = width;
+    em.height = height;
+    const size_t n = (size_t)width * height;
+    em.gx.assign(n, 0);
+    em.gy.assign(n, 0);
+    std::vector<int16_t> mag(n, 0);
+    auto sobelRow = cpu_has_avx2() ? sobel_row_avx2 : sobel_row_scalar;
+    for (int y = 1; y < height - 1; ++y) {
+        size_t o = (size_t)y * width;
+        sobelRow(gray + o - width, gray + o, gray + o + width, 1, width, &em.gx[o], &em.gy[o], &mag[o]);
+    }
+
+    std::vector<uint32_t> hist(2048, 0);
+    for (int16_t m : mag) ++hist[std::min<int>(m, 2047)];
+    uint64_t below = 0, target = (uint64_t)(EDGE_HIGH_QUANTILE * n);
+    int high = 0;
+    while (high < 2047 && below + hist[high] <= target) below += hist[high++];
+    high = std::max(high, EDGE_MIN_HIGH);
+    const int low = high / 2;
+
+    // Potiskivanje ne-maksimuma: sektor smjera iz odnosa |gx| i |gy| (tan 22.5° ~ 106/256)
+    enum : unsigned char { NONE = 0, WEAK = 1, STRONG = 2 };
+    std::vector<unsigned char> cls(n, NONE);
+    for (int y = 1; y < height - 1; ++y)
+        for (int x = 1; x < width - 1; ++x) {
+            size_t i = (size_t)y * width + x;
+            int m = mag[i];
+            if (m < low) continue;
+            int ax = std::abs(em.gx[i]), ay = std::abs(em.gy[i]);
+            int a, b;
+            if (ay * 256 < ax * 106) {
+                a = mag[i - 1], b = mag[i + 1];
+            } else if (ax * 256 < ay * 106) {
+                a = mag[i - width], b = mag[i + width];
+            } else if ((em.gx[i] > 0) == (em.gy[i] > 0)) {
+                a = mag[i - width - 1], b = mag[i + width + 1];
+            } else {
+                a = mag[i - width + 1], b = mag[i + width - 1];
+            }
+            if (m < a || m <= b) continue;
+            cls[i] = m >= high ? STRONG : WEAK;
+        }
+
+    // Histerezis: slabe ivice ostaju samo ako su povezane sa jakom
+    em.edges.assign(n, 0);
+    std::vector<size_t> stack;
+    for (size_t i = 0; i < n; ++i) {
+        if (cls[i] != STRONG || em.edges[i]) continue;
+        em.edges[i] = 255;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            size_t p = stack.back();
+            stack.pop_back();
+            int px = (int)(p % width), py = (int)(p / width);
+            for (int d = 0; d < 8; ++d) {
+                int qx = px + CONTOUR_DX[d], qy = py + CONTOUR_DY[d];
+                if (qx < 0 || qy < 0 || qx >= width || qy >= height) continue;
+                size_t q = (size_t)qy * width + qx;
+                if (cls[q] != NONE && !em.edges[q]) {
+                    em.edges[q] = 255;
+                    stack.push_back(q);
+                }
+            }
+        }
+    }
+}
+
+// Prava x cos(theta) + y sin(theta) = rho, theta u radijanima [0, pi)
+struct HoughLine {
+    float theta, rho;
+    int votes;
+};
+
+// Razlika smjerova prava u stepenima (0..90), uz to da su theta i theta + 180 ista prava
+float line_angle_diff(const HoughLine& a, const HoughLine& b) {
+    float d = std::fabs(a.theta - b.theta) * 180.0f / (float)M_PI;
+    return std::min(d, 180.0f - d);
+}
+
+// rho prave b izraženo u parametrizaciji prave a (kad su skoro paralelne preko granice 0/180°)
+float aligned_rho(const HoughLine& a, const HoughLine& b) {
+    return std::fabs(a.theta - b.theta) > (float)M_PI / 2 ? -b.rho : b.rho;
+}
+
+// Houghova transformacija (1° x 1 piksel): svaka ivica glasa za uglove do HOUGH_SPREAD
+// od smjera svog gradijenta, pa je cijena proporcionalna broju ivica. Vraća najviše
+// maxLines najjačih prava, međusobno udaljenih bar HOUGH_MIN_DTHETA / HOUGH_MIN_DRHO.
+std::vector<HoughLine> hough_lines(const EdgeMap& em, int maxLines, int minVotes) {
+    static const auto table = [] {
+        std::array<std::pair<int, int>, 180> t;   // cos, sin u Q10
+        for (int i = 0; i < 180; ++i)
+            t[i] = {(int)std::lround(std::cos(i * M_PI / 180) * 1024), (int)std::lround(std::sin(i * M_PI / 180) * 1024)};
+        return t;
+    }();
+    const int diag = (int)std::ceil(std::sqrt((double)em.width * em.width + (double)em.height * em.height));
+    const int rhoBins = 2 * diag + 1;
+    std::vector<uint16_t> acc((size_t)180 * rhoBins, 0);
+    for (int y = 1; y < em.height - 1; ++y)
+        for (int x = 1; x < em.width - 1; ++x) {
+            size_t i = (size_t)y * em.width + x;
+            if (!em.edges[i]) continue;
+            int a = (int)std::lround(std::atan2((float)em.gy[i], (float)em.gx[i]) * 180.0f / (float)M_PI);
+            for (int t = a - HOUGH_SPREAD; t <= a + HOUGH_SPREAD; ++t) {
+                int tb = ((t % 180) + 180) % 180;
+                int rho = (x * table[tb].first + y * table[tb].second + 512) >> 10;
+                uint16_t& v = acc[(size_t)tb * rhoBins + rho + diag];
+                if (v < UINT16_MAX) ++v;
+            }
+        }
+
+    // Glasovi ćelije sa susjedima po rho: prava između dva rho koša dijeli glasove
+    std::vector<std::pair<int, int>> cells;   // glasovi, indeks
+    for (int t = 0; t < 180; ++t) {
+        const uint16_t* row = &acc[(size_t)t * rhoBins];
+        for (int r = 1; r + 1 < rhoBins; ++r) {
+            int votes = row[r - 1] + row[r] + row[r + 1];
+            if (votes >= minVotes && row[r] >= row[r - 1] && row[r] >= row[r + 1])
+                cells.push_back({votes, t * rhoBins + r});
+        }
+    }
+    std::sort(cells.begin(), cells.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::vector<HoughLine> lines;
+    for (const auto& [votes, idx] : cells) {
+        HoughLine l{(idx / rhoBins) * (float)M_PI / 180, (float)(idx % rhoBins - diag), votes};
+        bool separate = true;
+        for (const auto& o : lines)
+            if (line_angle_diff(l, o) < HOUGH_MIN_DTHETA && std::fabs(aligned_rho(o, l) - o.rho) < HOUGH_MIN_DRHO) {
+                separate = false;
+                break;
+            }
+        if (!separate) continue;
+        lines.push_back(l);
+        if ((int)lines.size() == maxLines) break;
+    }
+    return lines;
+}
+
+// Presjek prave kroz a1, b1 i prave kroz a2, b2 (lineIntersection iz OpenCV/BVPoker.cpp)
+bool line_intersection(Point2f a1, Point2f b1, Point2f a2, Point2f b2, Point2f& intersection) {
+    double A1 = b1.y - a1.y, B1 = a1.x - b1.x, C1 = a1.x * A1 + a1.y * B1;
+    double A2 = b2.y - a2.y, B2 = a2.x - b2.x, C2 = a2.x * A2 + a2.y * B2;
+    double det = A1 * B2 - A2 * B1;
+    if (std::fabs(det) <= 1e-9 * std::max({1.0, std::fabs(A1 * B2), std::fabs(A2 * B1)})) return false;
+    intersection.x = (float)((C1 * B2 - C2 * B1) / det);
+    intersection.y = (float)((C2 * A1 - C1 * A2) / det);
+    return true;
+}
+
+bool hough_intersection(const HoughLine& a, const HoughLine& b, Point2f& p) {
+    auto points = [](const HoughLine& l, Point2f& p0, Point2f& p1) {
+        float c = std::cos(l.theta), s = std::sin(l.theta);
+        p0 = {l.rho * c, l.rho * s};
+        p1 = {p0.x - 100 * s, p0.y + 100 * c};
+    };
+    Point2f a0, a1, b0, b1;
+    points(a, a0, a1);
+    points(b, b0, b1);
+    return line_intersection(a0, a1, b0, b1, p);
+}
+
+// Uglovi četvorougla iz dva para naspramnih prava, redom po obodu
+bool hough_quad(const HoughLine& a1, const HoughLine& a2, const HoughLine& b1, const HoughLine& b2,
+                std::vector<Point2f>& quad) {
+    quad.resize(4);
+    return hough_intersection(a1, b1, quad[0]) && hough_intersection(a1, b2, quad[1]) &&
+           hough_intersection(a2, b2, quad[2]) && hough_intersection(a2, b1, quad[3]);
+}
+
+// Prava kroz ivice blizu l, između uglova from i to (najmanji kvadrati normalnih
+// odstupanja), da bi uglovi bili precizniji od ćelije akumulatora
+HoughLine refine_line(const EdgeMap& em, const HoughLine& l, Point2f from, Point2f to) {
+    int x0 = std::max(1, (int)std::min(from.x, to.x) - 3), x1 = std::min(em.width - 2, (int)std::max(from.x, to.x) + 3);
+    int y0 = std::max(1, (int)std::min(from.y, to.y) - 3), y1 = std::min(em.height - 2, (int)std::max(from.y, to.y) + 3);
+    // Prava iz Hough-a može biti zakošena za stepen-dva, pa se traka od 3 px oko nje
+    // prilagođava nekoliko puta da bi skliznula na cijelu stranicu
+    HoughLine cur = l;
+    for (int iter = 0; iter < REFINE_ITERATIONS; ++iter) {
+        const float c = std::cos(cur.theta), s = std::sin(cur.theta);
+        // Krajevi stranice (15%) se preskaču jer zaobljeni uglovi krive prilagođavanje
+        const float ta = -s * from.x + c * from.y, tb = -s * to.x + c * to.y;
+        const float margin = 0.15f * std::fabs(tb - ta);
+        const float t0 = std::min(ta, tb) + margin, t1 = std::max(ta, tb) - margin;
+        double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x) {
+                size_t i = (size_t)y * em.width + x;
+                if (!em.edges[i] || std::fabs(c * x + s * y - cur.rho) > 3.0f) continue;
+                // Tekstura podloge uz stranicu ima gradijent u drugom smjeru od normale
+                float gx = em.gx[i], gy = em.gy[i];
+                if (std::fabs(gx * c + gy * s) < REFINE_MIN_COS * std::sqrt(gx * gx + gy * gy)) continue;
+                float t = -s * x + c * y;
+                if (t < t0 || t > t1) continue;
+                n += 1;
+                sx += x;
+                sy += y;
+                sxx += (double)x * x;
+                sxy += (double)x * y;
+                syy += (double)y * y;
+            }
+        if (n < 10) break;
+        double mx = sx / n, my = sy / n;
+        double cxx = sxx / n - mx * mx, cxy = sxy / n - mx * my, cyy = syy / n - my * my;
+        double dir = 0.5 * std::atan2(2 * cxy, cxx - cyy);    // smjer najveće varijanse
+        double theta = dir + M_PI / 2;
+        if (theta >= M_PI) theta -= M_PI;
+        cur = {(float)theta, (float)(mx * std::cos(theta) + my * std::sin(theta)), l.votes};
+    }
+    return cur;
+}
+
+// Dio duži p0-p1 (uzorak po pikselu) koji leži na ivici iz mape near
+float segment_coverage(const std::vector<unsigned char>& near, int width, int height, Point2f p0, Point2f p1) {
+    int steps = (int)std::ceil(std::max(std::fabs(p1.x - p0.x), std::fabs(p1.y - p0.y)));
+    if (steps == 0) return 0;
+    int hits = 0;
+    for (int i = 0; i <= steps; ++i) {
+        int x = (int)std::lround(p0.x + (p1.x - p0.x) * i / steps);
+        int y = (int)std::lround(p0.y + (p1.y - p0.y) * i / steps);
+        if (x >= 0 && y >= 0 && x < width && y < height && near[(size_t)y * width + x]) ++hits;
+    }
+    return (float)hits / (steps + 1);
+}
+
+// Uglovi karte u sivoj ravni preko ivica; false kad nijedna četiri prave ne daju
+// četvorougao oblika karte
+bool edge_card_corners(const unsigned char* gray, int width, int height, int stride, std::array<Point2f, 4>& corners) {
+    const int s = std::min(EDGE_MAX_SCALE, std::max(1, (std::max(width, height) + EDGE_MAX_DIM - 1) / EDGE_MAX_DIM));
+    int w, h;
+    std::vector<unsigned char> small = downscale_plane(gray, width, height, stride, s, w, h);
+    if (w < 16 || h < 16) return false;
+    small = gaussian_blur_plane(small.data(), w, h, w);
+    EdgeMap em;
+    canny_edges(small.data(), w, h, em);
+    if (debug_enabled()) debug_image("step3_edges.jpg", w, h, 1, em.edges);
+
+    const int minSide = std::min(w, h);
+    auto lines = hough_lines(em, HOUGH_PEAKS, std::max(20, minSide / 10));
+
+    // Parovi naspramnih stranica, pa najveći četvorougao oblika karte čije su sve stranice
+    // dobro pokrivene ivicama (unutrašnji okvir slike na karti je često jača prava od ivice karte)
+    std::vector<std::pair<int, int>> pairs;
+    for (size_t i = 0; i < lines.size(); ++i)
+        for (size_t j = i + 1; j < lines.size(); ++j)
+            if (line_angle_diff(lines[i], lines[j]) <= EDGE_PARALLEL_DEG &&
+                std::fabs(aligned_rho(lines[i], lines[j]) - lines[i].rho) >= 0.1f * minSide)
+                pairs.push_back({(int)i, (int)j});
+    // Ivice proširene za piksel, za mjerenje pokrivenosti stranica
+    std::vector<unsigned char> near(em.edges.size(), 0);
+    for (int y = 1; y < h - 1; ++y)
+        for (int x = 1; x < w - 1; ++x)
+            if (em.edges[(size_t)y * w + x])
+                for (int dy = -1; dy <= 1; ++dy)
+                    std::memset(&near[(size_t)(y + dy) * w + x - 1], 1, 3);
+    float bestArea = 0;
+    std::vector<Point2f> best, quad;
+    std::array<int, 4> bestLines{};
+    for (size_t p = 0; p < pairs.size(); ++p)
+        for (size_t q = p + 1; q < pairs.size(); ++q) {
+            const HoughLine &a1 = lines[pairs[p].first], &a2 = lines[pairs[p].second];
+            const HoughLine &b1 = lines[pairs[q].first], &b2 = lines[pairs[q].second];
+            if (line_angle_diff(a1, b1) < EDGE_MIN_CORNER_DEG || line_angle_diff(a2, b2) < EDGE_MIN_CORNER_DEG) continue;
+            if (!hough_quad(a1, a2, b1, b2, quad)) continue;
+            float area = std::fabs(signed_area(quad));
+            if (area <= bestArea || area < 0.02f * w * h) continue;
+            bool inside = true;
+            for (const auto& c : quad)
+                if (c.x < -0.05f * w || c.y < -0.05f * h || c.x > 1.05f * w || c.y > 1.05f * h) inside = false;
+            float sideA = (distance(quad[0], quad[1]) + distance(quad[2], quad[3])) / 2;
+            float sideB = (distance(quad[1], quad[2]) + distance(quad[3], quad[0])) / 2;
+            float aspect = std::min(sideA, sideB) / std::max(sideA, sideB);
+            if (!inside || aspect < EDGE_MIN_ASPECT || aspect > EDGE_MAX_ASPECT) continue;
+            bool covered = true;
+            for (int k = 0; k < 4 && covered; ++k)
+                covered = segment_coverage(near, w, h, quad[k], quad[(k + 1) % 4]) >= EDGE_MIN_COVERAGE;
+            if (!covered) continue;
+            bestArea = area;
+            best = quad;
+            bestLines = {pairs[p].first, pairs[p].second, pairs[q].first, pairs[q].second};
+        }
+    if (best.empty()) {
+        LOG_DEBUG("Ivice: %zu prava, nijedan četvorougao oblika karte", lines.size());
+        return false;
+    }
+
+    // Svaka stranica se ponovo fituje kroz svoje ivice; a1 leži između uglova 0 i 1 itd.
+    HoughLine a1 = refine_line(em, lines[bestLines[0]], best[0], best[1]);
+    HoughLine a2 = refine_line(em, lines[bestLines[1]], best[3], best[2]);
+    HoughLine b1 = refine_line(em, lines[bestLines[2]], best[0], best[3]);
+    HoughLine b2 = refine_line(em, lines[bestLines[3]], best[1], best[2]);
+    if (hough_quad(a1, a2, b1, b2, quad)) best = quad;
+
+    // Presjeci su oštri uglovi van zaobljenja; kao u hull_corners, svaki se privlači
+    // najbližoj ivici unutar četvorougla (luku zaobljenja, ne teksturi stola), da bi
+    // isječak ugla bio isti kao iz konture
+    const int radius = std::max(2, minSide / 16);
+    const std::vector<Point2f> sharp = best;
+    const float orientation = signed_area(sharp) > 0 ? 1.0f : -1.0f;
+    auto inside = [&](int x, int y) {
+        for (int k = 0; k < 4; ++k) {
+            Point2f a = sharp[k], b = sharp[(k + 1) % 4];
+            float len = distance(a, b);
+            float side = ((b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x)) * orientation;
+            if (side < -1.0f * len) return false;   // više od piksela van stranice
+        }
+        return true;
+    };
+    for (auto& c : best) {
+        int cx = (int)std::lround(c.x), cy = (int)std::lround(c.y), bestD = INT_MAX;
+        for (int y = std::max(0, cy - radius); y <= std::min(h - 1, cy + radius); ++y)
+            for (int x = std::max(0, cx - radius); x <= std::min(w - 1, cx + radius); ++x) {
+                int d = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                if (em.edges[(size_t)y * w + x] && d < bestD && inside(x, y)) {
+                    bestD = d;
+                    c = {(float)x, (float)y};
+                }
+            }
+    }
+
+    for (auto& c : best) {
+        c.x = std::clamp((c.x + 0.5f) * s - 0.5f, 0.0f, (float)(width - 1));
+        c.y = std::clamp((c.y + 0.5f) * s - 0.5f, 0.0f, (float)(height - 1));
+    }
+    corners = quad_corners(best);
+    return true;
+}
+
+void save_image(const std::string& filename, const std::vector<unsigned char>& image, int width, int height) {
+    stbi_write_png(filename.c_str(), width, height, 3, image.data(), width * 3);
+}
+
+// Ispravljanje perspektive; sample(px, py, rgb) daje RGB piksel izvora, pa isti
+// kod radi i za RGB slike i za YUV/sive frejmove bez konverzije cijelog frejma
+template <typename Sampler>
+std::vector<unsigned char> warp_sampled(int srcW, int srcH, const std::array<Point2f, 4>& corners, int dstW, int dstH,
+                                        Sampler sample) {
+    std::vector<unsigned char> output(dstW * dstH * 3);
+
+    for (int y = 0; y < dstH; ++y) {
+        float v = y / (float)(dstH - 1);
+        for (int x = 0; x < dstW; ++x) {
+            float u = x / (float)(dstW - 1);
+
+            Point2f top = {
+                (1 - u) * corners[0].x + u * corners[1].x,
+                (1 - u) * corners[0].y + u * corners[1].y
+            };
+            Point2f bottom = {
+                (1 - u) * corners[3].x + u * corners[2].x,
+                (1 - u) * corners[3].y + u * corners[2].y
+            };
+            Point2f p = {
+                (1 - v) * top.x + v * bottom.x,
+                (1 - v) * top.y + v * bottom.y
+            };
+
+            int px = std::clamp((int)p.x, 0, srcW - 1);
+            int py = std::clamp((int)p.y, 0, srcH - 1);
+            sample(px, py, &output[(y * dstW + x) * 3]);
+        }
+    }
+
+    // Flip horizontally to ensure number and symbol are in top-left
+    std::vector<unsigned char> flipped(dstW * dstH * 3);
+    for (int y = 0; y < dstH; ++y) {
+        for (int x = 0; x < dstW; ++x) {
+            for (int c = 0; c < 3; ++c) {
+                flipped[(y * dstW + x) * 3 + c] = output[(y * dstW + (dstW - 1 - x)) * 3 + c];
+            }
+        }
+    }
+    return flipped;
+}
+
+std::vector<unsigned char> warp_image(const unsigned char* input, int srcW, int srcH, std::array<Point2f, 4> corners, int dstW, int dstH) {
+    return warp_sampled(srcW, srcH, corners, dstW, dstH, [&](int px, int py, unsigned char* rgb) {
+        for (int c = 0; c < 3; ++c) rgb[c] = input[(py * srcW + px) * 3 + c];
+    });
+}
+
+void save_top_left_corner(const std::vector<unsigned char>& image, int width, int height, int cornerW, int cornerH, const std::string& filename) {
     std::vector<unsigned char> cropped(cornerW * cornerH * 3);
     for (int y = 0; y < cornerH; ++y) {
         for (int x = 0; x < cornerW; ++x) {
@@ -195,7 +1998,7 @@ int get_image_height(const std::string& filename) {
     int width, height, channels;
     unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, 3);
     if (!data) {
-        std::cerr << "Greska pri ucitavanju slike: " << filename << std::endl;
+        LOG_ERROR("Greska pri ucitavanju slike: %s", filename.c_str());
         return -1;
     }
     stbi_image_free(data);
@@ -203,36 +2006,32 @@ int get_image_height(const std::string& filename) {
 }
 
 
-void split_symbol_image(const std::string& filename) {
-    int width, height, channels;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, 3);
-    if (!data) {
-        std::cerr << "Greska pri ucitavanju slike: " << filename << std::endl;
-        return;
-    }
-
+// Dijeli isječak simbola na gornji dio (rank, 60% visine) i donji dio (suit).
+// Uz --debug-artifacts dijelovi se snimaju i kao "broj.png" i "znak.png".
+void split_symbol_image(const std::vector<unsigned char>& data, int width, int height,
+                        std::vector<unsigned char>& topHalf, int& topH,
+                        std::vector<unsigned char>& bottomHalf, int& bottomH) {
    // int mid = height / 2;
     int mid = static_cast<int>(height * 0.60); 
     // Gornja polovina - "broj.png"
-    std::vector<unsigned char> topHalf(width * mid * 3);
+    topH = mid;
+    topHalf.assign(width * mid * 3, 0);
     for (int y = 0; y < mid; ++y)
         for (int x = 0; x < width; ++x)
             for (int c = 0; c < 3; ++c)
                 topHalf[(y * width + x) * 3 + c] = data[(y * width + x) * 3 + c];
 
-    stbi_write_png("broj.png", width, mid, 3, topHalf.data(), width * 3);
+    if (debug_enabled()) debug_image("broj.png", width, mid, 3, topHalf);
 
     // Donja polovina - "znak.png"
-    int bottomH = height - mid;
-    std::vector<unsigned char> bottomHalf(width * bottomH * 3);
+    bottomH = height - mid;
+    bottomHalf.assign(width * bottomH * 3, 0);
     for (int y = 0; y < bottomH; ++y)
         for (int x = 0; x < width; ++x)
             for (int c = 0; c < 3; ++c)
                 bottomHalf[(y * width + x) * 3 + c] = data[((y + mid) * width + x) * 3 + c];
 
-    stbi_write_png("znak.png", width, bottomH, 3, bottomHalf.data(), width * 3);
-
-    stbi_image_free(data);
+    if (debug_enabled()) debug_image("znak.png", width, bottomH, 3, bottomHalf);
 }
 
 int count_white_pixels(const std::vector<unsigned char>& img, int width, int height) {
@@ -429,19 +2228,59 @@ int matchSuit(const std::vector<unsigned char>& suitImg, int width, int height)
     return bestMatch;
 }*/
 
-int rankMatcher(const std::vector<unsigned char>& rankImg, int width, int height) {
-    const std::vector<std::pair<std::string, int>> templates = {
-        {"Card_Imgs/Ranks/2.jpg", 1}, {"Card_Imgs/Ranks/3.jpg", 2},
-        {"Card_Imgs/Ranks/4.jpg", 3}, {"Card_Imgs/Ranks/5.jpg", 4},
-        {"Card_Imgs/Ranks/6.jpg", 5}, {"Card_Imgs/Ranks/7.jpg", 6},
-        {"Card_Imgs/Ranks/8.jpg", 7}, {"Card_Imgs/Ranks/9.jpg", 8},
-        {"Card_Imgs/Ranks/0.jpg", 9}, {"Card_Imgs/Ranks/jack.jpg", 10},
-        {"Card_Imgs/Ranks/queen.jpg", 11}, {"Card_Imgs/Ranks/king.jpg", 12},
-        {"Card_Imgs/Ranks/ace.jpg", 13}
-    };
+// Tijesni bbox najveće komponente simbola u isječku ranka ili suita
+struct SymbolBox {
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    bool empty() const { return maxX < minX; }
+};
+
+// Izrezuje bbox sa paddingom od 2 piksela; invert daje simbol = 255 iz isječka sa simbolom = 0
+std::vector<unsigned char> crop_symbol_box(const std::vector<unsigned char>& img, int width, int height,
+                                           const SymbolBox& box, int& cropW, int& cropH, bool invert = false) {
+    cropW = cropH = 0;
+    if (box.empty()) return {};
+
+    // Dodaj padding i osiguraj granice
+    const int padding = 2;
+    int minX = std::max(0, box.minX - padding);
+    int minY = std::max(0, box.minY - padding);
+    int maxX = std::min(width - 1, box.maxX + padding);
+    int maxY = std::min(height - 1, box.maxY + padding);
+
+    // Izreži regiju
+    cropW = maxX - minX;
+    cropH = maxY - minY;
+    if (cropW <= 0 || cropH <= 0) {
+        cropW = cropH = 0;
+        return {};
+    }
+    const unsigned char flip = invert ? 255 : 0;
+    std::vector<unsigned char> cropped(cropW * cropH);
+    for (int y = 0; y < cropH; y++)
+        for (int x = 0; x < cropW; x++) cropped[y * cropW + x] = img[(y + minY) * width + x + minX] ^ flip;
+    return cropped;
+}
+
+// Izrezuje bbox najveće komponente (simbol = 255) sa paddingom od 2 piksela
+std::vector<unsigned char> crop_largest_component(const std::vector<unsigned char>& img, int width, int height,
+                                                  int& cropW, int& cropH) {
+    SymbolBox box;
+    std::vector<Point2f> largest = find_largest_component(img, width, height);
+    if (!largest.empty()) box = {width, height, 0, 0};
+    for (const auto& p : largest) {
+        box.minX = std::min(box.minX, (int)p.x);
+        box.maxX = std::max(box.maxX, (int)p.x);
+        box.minY = std::min(box.minY, (int)p.y);
+        box.maxY = std::max(box.maxY, (int)p.y);
+    }
+    return crop_symbol_box(img, width, height, box, cropW, cropH);
+}
+
+int rankMatcher(const std::vector<unsigned char>& rankImg, int width, int height, float* margin) {
+    const auto& templates = RANK_TEMPLATES;
 
     int bestMatch = -1;
-    int minDiff = INT_MAX;
+    int minDiff = INT_MAX, secondDiff = INT_MAX;
 
     // Invertujemo sliku za obradu
     std::vector<unsigned char> inverted(rankImg.size());
@@ -449,43 +2288,16 @@ int rankMatcher(const std::vector<unsigned char>& rankImg, int width, int height
         inverted[i] = 255 - rankImg[i];
     }
 
-    // Pronađi najveću komponentu
-    std::vector<Point2f> largest = find_largest_component(inverted, width, height);
-    if (largest.empty()) {
-        std::cerr << "Nema kontura za obradu!" << std::endl;
+    // Izreži regiju najveće komponente
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = crop_largest_component(inverted, width, height, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
         return -1;
     }
 
-    // Pronađi granice konture
-    float minX = width, maxX = 0, minY = height, maxY = 0;
-    for (const auto& p : largest) {
-        minX = std::min(minX, p.x);
-        maxX = std::max(maxX, p.x);
-        minY = std::min(minY, p.y);
-        maxY = std::max(maxY, p.y);
-    }
-
-    // Dodaj padding i osiguraj granice
-    const int padding = 2;
-    minX = std::max(0.0f, minX - padding);
-    minY = std::max(0.0f, minY - padding);
-    maxX = std::min((float)width - 1, maxX + padding);
-    maxY = std::min((float)height - 1, maxY + padding);
-
-    // Izreži regiju
-    int cropW = maxX - minX;
-    int cropH = maxY - minY;
-    std::vector<unsigned char> cropped(cropW * cropH);
-    for (int y = 0; y < cropH; y++) {
-        for (int x = 0; x < cropW; x++) {
-            int srcX = x + minX;
-            int srcY = y + minY;
-            cropped[y * cropW + x] = inverted[srcY * width + srcX];
-        }
-    }
-
     // Sačuvaj debug sliku
-    stbi_write_png("_debug_cropped_rank.png", cropW, cropH, 1, cropped.data(), cropW);
+    if (debug_enabled()) debug_image("_debug_cropped_rank.png", cropW, cropH, 1, cropped);
 
     for (const auto& [file, rank] : templates) {
         // Učitaj template
@@ -516,15 +2328,19 @@ int rankMatcher(const std::vector<unsigned char>& rankImg, int width, int height
 
         // Ažuriraj najbolji rezultat
         if (diff < minDiff) {
+            secondDiff = minDiff;
             minDiff = diff;
             bestMatch = rank;
+        } else if (diff < secondDiff) {
+            secondDiff = diff;
         }
 
         stbi_image_free(tplData);
-        std::cout << " -> Rank " << rank << " has diff: " << diff << std::endl;
+        LOG_DEBUG(" -> Rank %d has diff: %d", rank, diff);
     }
 
-    std::cout << "[RESULT] Best match rank: " << bestMatch << std::endl;
+    LOG_DEBUG("Best match rank: %d", bestMatch);
+    if (margin) *margin = match_margin((float)minDiff, secondDiff == INT_MAX ? 1e30f : (float)secondDiff);
     return bestMatch;
 }
 
@@ -558,16 +2374,11 @@ std::vector<unsigned char> bilinear_resize(const std::vector<unsigned char>& inp
     return resized;
 }
 
-int matchSuit(const std::vector<unsigned char>& suitImg, int width, int height) {
-    const std::vector<std::pair<std::string, int>> templates = {
-        {"Card_Imgs/Suits/hearts.jpg", 0},
-        {"Card_Imgs/Suits/diamonds.jpg", 1},
-        {"Card_Imgs/Suits/clubs.jpg", 2},
-        {"Card_Imgs/Suits/spades.jpg", 3}
-    };
+int matchSuit(const std::vector<unsigned char>& suitImg, int width, int height, unsigned candidates, float* margin) {
+    const auto& templates = SUIT_TEMPLATES;
 
     int bestMatch = -1;
-    int minDiff = INT_MAX;
+    int minDiff = INT_MAX, secondDiff = INT_MAX;
 
     // Invertujemo sliku za obradu
     std::vector<unsigned char> inverted(suitImg.size());
@@ -575,53 +2386,28 @@ int matchSuit(const std::vector<unsigned char>& suitImg, int width, int height)
         inverted[i] = 255 - suitImg[i];
     }
 
-    // Pronađi najveću komponentu
-    std::vector<Point2f> largest = find_largest_component(inverted, width, height);
-    if (largest.empty()) {
-        std::cerr << "Nema kontura za obradu!" << std::endl;
+    // Izreži regiju najveće komponente
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = crop_largest_component(inverted, width, height, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
         return -1;
     }
 
-    // Pronađi granice konture
-    float minX = width, maxX = 0, minY = height, maxY = 0;
-    for (const auto& p : largest) {
-        minX = std::min(minX, p.x);
-        maxX = std::max(maxX, p.x);
-        minY = std::min(minY, p.y);
-        maxY = std::max(maxY, p.y);
-    }
-
-    // Dodaj padding i osiguraj granice
-    const int padding = 2;
-    minX = std::max(0.0f, minX - padding);
-    minY = std::max(0.0f, minY - padding);
-    maxX = std::min((float)width - 1, maxX + padding);
-    maxY = std::min((float)height - 1, maxY + padding);
-
-    // Izreži regiju
-    int cropW = maxX - minX;
-    int cropH = maxY - minY;
-    std::vector<unsigned char> cropped(cropW * cropH);
-    for (int y = 0; y < cropH; y++) {
-        for (int x = 0; x < cropW; x++) {
-            int srcX = x + minX;
-            int srcY = y + minY;
-            cropped[y * cropW + x] = inverted[srcY * width + srcX];
-        }
-    }
-
     // Sačuvaj debug sliku pre resize-a
-    stbi_write_png("_debug_cropped_suit.png", cropW, cropH, 1, cropped.data(), cropW);
+    if (debug_enabled()) debug_image("_debug_cropped_suit.png", cropW, cropH, 1, cropped);
 
     // Resizeuj cropped sliku na dimenzije template-a
     int tplW = 70, tplH = 100;  // Primer dimenzija za template
     std::vector<unsigned char> resized = bilinear_resize(cropped, cropW, cropH, tplW, tplH);
 
     // Sačuvaj resized sliku za debagovanje
-    stbi_write_png("_debug_resized_suit.png", tplW, tplH, 1, resized.data(), tplW);
+    if (debug_enabled()) debug_image("_debug_resized_suit.png", tplW, tplH, 1, resized);
 
-    // Iteriraj kroz template slike
+    // Iteriraj kroz template slike (samo kandidate iste boje)
     for (const auto& [file, suit] : templates) {
+        if (!(candidates & (1u << suit))) continue;
+
         // Učitaj template
         int tplC;
         unsigned char* tplData = stbi_load(file.c_str(), &tplW, &tplH, &tplC, 0);
@@ -638,173 +2424,4304 @@ int matchSuit(const std::vector<unsigned char>& suitImg, int width, int height)
 
         // Ažuriraj najbolji rezultat
         if (diff < minDiff) {
+            secondDiff = minDiff;
             minDiff = diff;
             bestMatch = suit;
+        } else if (diff < secondDiff) {
+            secondDiff = diff;
         }
 
         stbi_image_free(tplData);
-        std::cout << " -> Suit " << suit << " has diff: " << diff << std::endl;
+        LOG_DEBUG(" -> Suit %d has diff: %d", suit, diff);
     }
 
-    std::cout << "[RESULT] Best match suit: " << bestMatch << std::endl;
+    LOG_DEBUG("Best match suit: %d", bestMatch);
+    if (margin) *margin = match_margin((float)minDiff, secondDiff == INT_MAX ? 1e30f : (float)secondDiff);
     return bestMatch;
 }
 
 
 
-int main() {
-    int width, height, channels;
-    
-    unsigned char* image = stbi_load("karta.jpeg", &width, &height, &channels, 3);
-    if (!image) {
-        std::cerr << "Greska pri ucitavanju slike!" << std::endl;
-        return 1;
+// ---------------------------------------------------------------------------
+// Feature-vector klasifikator (alternativa poređenju piksel po piksel)
+// ---------------------------------------------------------------------------
+
+const int FEAT_ZONES_X = 4;   // zoning mreža 4x6
+const int FEAT_ZONES_Y = 6;
+const int FEAT_PROJ = 8;      // binovi horizontalne i vertikalne projekcije
+const int FEAT_HU = 7;
+const int FEAT_LEN = FEAT_ZONES_X * FEAT_ZONES_Y + 2 * FEAT_PROJ + FEAT_HU + 1;
+
+using FeatureVector = std::array<float, FEAT_LEN>;
+
+// Težine grupa pri računanju rastojanja (zone, projekcije, Hu momenti, broj rupa)
+const float FEAT_W_ZONE = 1.0f, FEAT_W_PROJ = 1.0f, FEAT_W_HU = 0.05f, FEAT_W_HOLES = 0.5f;
+
+// Sljedeća pozicija u [x, end) gdje bit reda ima vrijednost set; end ako je nema
+inline int find_bit(const uint64_t* row, int x, int end, bool set) {
+    while (x < end) {
+        uint64_t w = (set ? row[x >> 6] : ~row[x >> 6]) & (~0ull << (x & 63));
+        if (w) return std::min(end, (x & ~63) + __builtin_ctzll(w));
+        x = (x & ~63) + 64;
+    }
+    return end;
+}
+
+// Zbirovi x, x^2 i x^3 za x u [0, n); zbir po run-u [a, b) je razlika dva poziva
+inline int64_t power_sum1(int64_t n) { return n * (n - 1) / 2; }
+inline int64_t power_sum2(int64_t n) { return (n - 1) * n * (2 * n - 1) / 6; }
+inline int64_t power_sum3(int64_t n) { return power_sum1(n) * power_sum1(n); }
+
+// 4-povezane komponente po run-ovima: run-ovi jednog reda se spajaju (union-find) sa
+// run-ovima prethodnog reda sa kojima dijele kolonu. Za rupe se dodaju run-ovi pozadine
+// (rupa ne dodiruje ivicu), a za simbol run-ovi simbola.
+struct RunComponents {
+    struct Run {
+        int a, b, label;
+    };
+    struct Component {
+        int parent, area;
+        bool border;
+        int first;                 // prvi run komponente u rasterskom redu
+        int minX, minY, maxX, maxY;
+    };
+    std::vector<Run> prev, cur;
+    std::vector<Component> comps;
+    size_t first = 0;   // prvi run prethodnog reda koji može dodirnuti sljedeći run
+    int y = 0;
+
+    int find(int i) {
+        while (comps[i].parent != i) i = comps[i].parent = comps[comps[i].parent].parent;
+        return i;
+    }
+
+    void add(int a, int b, bool touchesBorder = false) {
+        int label = (int)comps.size();
+        comps.push_back({label, b - a, touchesBorder, label, a, y, b - 1, y});
+        while (first < prev.size() && prev[first].b <= a) ++first;
+        for (size_t i = first; i < prev.size() && prev[i].a < b; ++i) {
+            int r1 = find(label), r2 = find(prev[i].label);
+            if (r1 == r2) continue;
+            Component &c = comps[r1], &o = comps[r2];
+            o.parent = r1;
+            c.area += o.area;
+            c.border |= o.border;
+            c.first = std::min(c.first, o.first);
+            c.minX = std::min(c.minX, o.minX);
+            c.minY = std::min(c.minY, o.minY);
+            c.maxX = std::max(c.maxX, o.maxX);
+        }
+        cur.push_back({a, b, label});
     }
 
-    // 1. Convert to grayscale
-    std::vector<unsigned char> gray(width * height);
+    void next_row() {
+        std::swap(prev, cur);
+        cur.clear();
+        first = 0;
+        ++y;
+    }
+
+    // Korijen najveće komponente; od jednakih ona koja počinje ranije, kao u find_largest_component
+    int largest() const {
+        int best = -1;
+        for (int i = 0; i < (int)comps.size(); ++i) {
+            if (comps[i].parent != i) continue;
+            if (best < 0 || comps[i].area > comps[best].area ||
+                (comps[i].area == comps[best].area && comps[i].first < comps[best].first))
+                best = i;
+        }
+        return best;
+    }
+
+    int count(int minArea) const {
+        int holes = 0;
+        for (int i = 0; i < (int)comps.size(); ++i)
+            if (comps[i].parent == i && !comps[i].border && comps[i].area >= minArea) ++holes;
+        return holes;
+    }
+};
+
+// Bbox najveće komponente simbola (= 0) u binarnom isječku ranka ili suita. Isti izbor
+// kao find_largest_component nad invertovanim isječkom, ali po run-ovima, bez BFS-a po pikselima.
+SymbolBox largest_symbol_box(const std::vector<unsigned char>& binary, int width, int height) {
+    BitPlane bits = pack_plane(binary.data(), width, height, width, 127);
+    RunComponents runs;
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            int idx = (y * width + x) * 3;
-            unsigned char r = image[idx], g = image[idx + 1], b = image[idx + 2];
-            gray[y * width + x] = static_cast<unsigned char>(0.299 * r + 0.587 * g + 0.114 * b);
+        const uint64_t* row = bits.row(y);
+        for (int x = 0; x < width;) {
+            int a = find_bit(row, x, width, false);
+            if (a >= width) break;
+            int b = find_bit(row, a, width, true);
+            runs.add(a, b);
+            x = b;
         }
+        runs.next_row();
     }
+    SymbolBox box;
+    int i = runs.largest();
+    if (i >= 0) box = {runs.comps[i].minX, runs.comps[i].minY, runs.comps[i].maxX, runs.comps[i].maxY};
+    return box;
+}
 
-    // 2. Binarize image
-    auto binary = binarize_image(gray, width, height, 120);
-    stbi_write_png("step3_binary.jpg", width, height, 1, binary.data(), width);
+// Računa vektor osobina binarne slike (simbol = 255). Koordinate se normalizuju na
+// tijesni bbox simbola, pa je vektor neosjetljiv na padding i razmjeru isječka.
+// Slika se pakuje u bitove (AVX2 poređenje + movemask), a jedan prolaz po run-ovima
+// reda daje momente, zone, projekcije i rupe.
+FeatureVector extract_features(const std::vector<unsigned char>& img, int width, int height) {
+    FeatureVector f{};
+    BitPlane bits = pack_plane(img.data(), width, height, width, 127);
 
-    // 3. Find largest component (card)
-    auto largest = find_largest_component(binary, width, height);
-    if (largest.size() < 100) {
-        std::cerr << "Nema dovoljno velika kontura!" << std::endl;
-        stbi_image_free(image);
-        return 1;
+    // Tijesni bbox simbola iz riječi
+    int minX = width, minY = height, maxX = -1, maxY = -1;
+    for (int y = 0; y < height; ++y) {
+        const uint64_t* row = bits.row(y);
+        for (int k = 0; k < bits.words; ++k)
+            if (row[k]) {
+                minX = std::min(minX, k * 64 + __builtin_ctzll(row[k]));
+                break;
+            }
+        for (int k = bits.words - 1; k >= 0; --k)
+            if (row[k]) {
+                maxX = std::max(maxX, k * 64 + 63 - __builtin_clzll(row[k]));
+                minY = std::min(minY, y);
+                maxY = y;
+                break;
+            }
+    }
+    if (maxX < 0) return f;
+
+    const int w = maxX - minX + 1, h = maxY - minY + 1;
+    std::vector<int> zoneOfX(w), colDiff(w + 1, 0), colSum(w, 0);
+    for (int x = 0; x < w; ++x) zoneOfX[x] = x * FEAT_ZONES_X / w;
+
+    float zones[FEAT_ZONES_Y][FEAT_ZONES_X] = {};
+    float rowProj[FEAT_PROJ] = {};
+    double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0, m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+    RunComponents holes;
+
+    // Po redu: run-ovi simbola daju momente (s0..s3) i razliku kolona tekuće zone,
+    // a run-ovi pozadine idu u komponente za rupe
+    int zoneY = 0;
+    for (int y = 0; y < h; ++y) {
+        const uint64_t* row = bits.row(minY + y);
+        int64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        bool edgeRow = y == 0 || y == h - 1;
+        for (int x = minX; x <= maxX;) {
+            int a = find_bit(row, x, maxX + 1, true);
+            if (a > x) holes.add(x - minX, a - minX, edgeRow || x == minX || a == maxX + 1);
+            if (a > maxX) break;
+            int b = find_bit(row, a, maxX + 1, false);
+            int la = a - minX, lb = b - minX;
+            s0 += lb - la;
+            s1 += power_sum1(lb) - power_sum1(la);
+            s2 += power_sum2(lb) - power_sum2(la);
+            s3 += power_sum3(lb) - power_sum3(la);
+            ++colDiff[la];
+            --colDiff[lb];
+            x = b;
+        }
+        holes.next_row();
+
+        double fy = y;
+        m00 += s0;            m10 += s1;            m20 += s2;     m30 += s3;
+        m01 += fy * s0;       m11 += fy * s1;       m21 += fy * s2;
+        m02 += fy * fy * s0;  m12 += fy * fy * s1;
+        m03 += fy * fy * fy * s0;
+        rowProj[y * FEAT_PROJ / h] += s0;
+
+        // Kraj reda zona: prefiks razlika daje broj piksela po koloni
+        int nextZoneY = (y + 1 < h) ? (y + 1) * FEAT_ZONES_Y / h : FEAT_ZONES_Y;
+        if (nextZoneY != zoneY) {
+            int acc = 0;
+            for (int x = 0; x < w; ++x) {
+                acc += colDiff[x];
+                zones[zoneY][zoneOfX[x]] += acc;
+                colSum[x] += acc;
+            }
+            std::fill(colDiff.begin(), colDiff.end(), 0);
+            zoneY = nextZoneY;
+        }
+    }
+    if (m00 == 0) return f;
+
+    int k = 0;
+
+    // Gustine zona
+    for (int zy = 0; zy < FEAT_ZONES_Y; ++zy)
+        for (int zx = 0; zx < FEAT_ZONES_X; ++zx) {
+            int zw = (zx + 1) * w / FEAT_ZONES_X - zx * w / FEAT_ZONES_X;
+            int zh = (zy + 1) * h / FEAT_ZONES_Y - zy * h / FEAT_ZONES_Y;
+            f[k++] = (zw > 0 && zh > 0) ? zones[zy][zx] / (zw * zh) : 0.0f;
+        }
+
+    // Projekcije (gustina po binu)
+    for (int b = 0; b < FEAT_PROJ; ++b) {
+        int rows = (b + 1) * h / FEAT_PROJ - b * h / FEAT_PROJ;
+        f[k++] = rows > 0 ? rowProj[b] / (rows * w) : 0.0f;
+    }
+    float colProj[FEAT_PROJ] = {};
+    for (int x = 0; x < w; ++x) colProj[x * FEAT_PROJ / w] += colSum[x];
+    for (int b = 0; b < FEAT_PROJ; ++b) {
+        int cols = (b + 1) * w / FEAT_PROJ - b * w / FEAT_PROJ;
+        f[k++] = cols > 0 ? colProj[b] / (cols * h) : 0.0f;
+    }
+
+    // Hu momenti u koordinatama normalizovanim na bbox (šabloni su razvučeni na 70x125)
+    const double sx = 1.0 / w, sy = 1.0 / h;
+    const double a = sx * sy;
+    double n00 = m00 * a;
+    double n10 = m10 * a * sx, n01 = m01 * a * sy;
+    double n20 = m20 * a * sx * sx, n11 = m11 * a * sx * sy, n02 = m02 * a * sy * sy;
+    double n30 = m30 * a * sx * sx * sx, n21 = m21 * a * sx * sx * sy;
+    double n12 = m12 * a * sx * sy * sy, n03 = m03 * a * sy * sy * sy;
+
+    double xc = n10 / n00, yc = n01 / n00;
+    double mu20 = n20 - xc * n10, mu02 = n02 - yc * n01, mu11 = n11 - xc * n01;
+    double mu30 = n30 - 3 * xc * n20 + 2 * xc * xc * n10;
+    double mu03 = n03 - 3 * yc * n02 + 2 * yc * yc * n01;
+    double mu21 = n21 - 2 * xc * n11 - yc * n20 + 2 * xc * xc * n01;
+    double mu12 = n12 - 2 * yc * n11 - xc * n02 + 2 * yc * yc * n10;
+
+    double s2 = n00 * n00, s3 = std::pow(n00, 2.5);
+    double e20 = mu20 / s2, e02 = mu02 / s2, e11 = mu11 / s2;
+    double e30 = mu30 / s3, e03 = mu03 / s3, e21 = mu21 / s3, e12 = mu12 / s3;
+
+    double hu[FEAT_HU];
+    hu[0] = e20 + e02;
+    hu[1] = (e20 - e02) * (e20 - e02) + 4 * e11 * e11;
+    hu[2] = (e30 - 3 * e12) * (e30 - 3 * e12) + (3 * e21 - e03) * (3 * e21 - e03);
+    hu[3] = (e30 + e12) * (e30 + e12) + (e21 + e03) * (e21 + e03);
+    hu[4] = (e30 - 3 * e12) * (e30 + e12) * ((e30 + e12) * (e30 + e12) - 3 * (e21 + e03) * (e21 + e03)) +
+            (3 * e21 - e03) * (e21 + e03) * (3 * (e30 + e12) * (e30 + e12) - (e21 + e03) * (e21 + e03));
+    hu[5] = (e20 - e02) * ((e30 + e12) * (e30 + e12) - (e21 + e03) * (e21 + e03)) +
+            4 * e11 * (e30 + e12) * (e21 + e03);
+    hu[6] = (3 * e21 - e03) * (e30 + e12) * ((e30 + e12) * (e30 + e12) - 3 * (e21 + e03) * (e21 + e03)) -
+            (e30 - 3 * e12) * (e21 + e03) * (3 * (e30 + e12) * (e30 + e12) - (e21 + e03) * (e21 + e03));
+
+    // Log skala odsječena na 1e-8: viši momenti simetričnih simbola su praktično nula
+    // pa bi obični -sign(h) * log10|h| pojačavao šum i mijenjao znak
+    for (int i = 0; i < FEAT_HU; ++i) {
+        double v = std::max(0.0, std::log10(std::fabs(hu[i]) + 1e-30) + 8.0);
+        f[k++] = (float)std::copysign(v, hu[i]);
+    }
+
+    f[k++] = (float)holes.count(std::max(2, w * h / 200));   // manje oblasti su šum
+    return f;
+}
+
+float feature_distance(const FeatureVector& a, const FeatureVector& b) {
+    static const std::array<float, FEAT_LEN> weights = [] {
+        std::array<float, FEAT_LEN> w{};
+        int k = 0;
+        for (int i = 0; i < FEAT_ZONES_X * FEAT_ZONES_Y; ++i) w[k++] = FEAT_W_ZONE;
+        for (int i = 0; i < 2 * FEAT_PROJ; ++i) w[k++] = FEAT_W_PROJ;
+        for (int i = 0; i < FEAT_HU; ++i) w[k++] = FEAT_W_HU;
+        w[k++] = FEAT_W_HOLES;
+        return w;
+    }();
+
+    float d = 0;
+    for (int i = 0; i < FEAT_LEN; ++i) {
+        float t = a[i] - b[i];
+        d += weights[i] * t * t;
+    }
+    return d;
+}
+
+struct FeatureCentroid {
+    int label;
+    FeatureVector center;
+};
+
+// Nearest-centroid model: za svaki šablon prosjek vektora originala i nekoliko
+// umanjenih verzija (isječak iz ugla karte je mnogo manje rezolucije od šablona)
+std::vector<FeatureCentroid> build_feature_centroids(const std::vector<std::pair<std::string, int>>& templates) {
+    const int scales[][2] = {{0, 0}, {14, 25}, {20, 36}, {28, 50}};
+    std::vector<FeatureCentroid> centroids;
+
+    const TemplateSet set = load_template_set(templates);
+    const int tplW = set.width, tplH = set.height;
+    for (size_t t = 0; t < set.gray.size(); ++t) {
+        std::vector<unsigned char> tplBinary = binarize(set.gray[t].data(), tplW, tplH, 1);
+
+        FeatureCentroid c{set.labels[t], {}};
+        int n = 0;
+        for (const auto& s : scales) {
+            int w = s[0] ? s[0] : tplW, h = s[1] ? s[1] : tplH;
+            std::vector<unsigned char> scaled(w * h);
+            for (int y = 0; y < h; ++y)
+                for (int x = 0; x < w; ++x)
+                    scaled[y * w + x] = tplBinary[(y * tplH / h) * tplW + x * tplW / w];
+
+            FeatureVector v = extract_features(scaled, w, h);
+            for (int i = 0; i < FEAT_LEN; ++i) c.center[i] += v[i];
+            ++n;
+        }
+        for (int i = 0; i < FEAT_LEN; ++i) c.center[i] /= n;
+        centroids.push_back(c);
+    }
+    return centroids;
+}
+
+int classify_features(const FeatureVector& v, const std::vector<FeatureCentroid>& centroids, const char* what,
+                      unsigned candidates = ~0u, float* margin = nullptr) {
+    int bestMatch = -1;
+    float minDist = 1e30f, secondDist = 1e30f;
+    for (const auto& c : centroids) {
+        if (!(candidates & (1u << c.label))) continue;
+        float d = feature_distance(v, c.center);
+        LOG_DEBUG(" -> %s %d has dist: %g", what, c.label, d);
+        if (d < minDist) {
+            secondDist = minDist;
+            minDist = d;
+            bestMatch = c.label;
+        } else if (d < secondDist) {
+            secondDist = d;
+        }
+    }
+    if (margin) *margin = match_margin(minDist, secondDist);
+    return bestMatch;
+}
+
+const std::vector<FeatureCentroid>& rank_feature_centroids() {
+    static const std::vector<FeatureCentroid> centroids = build_feature_centroids(RANK_TEMPLATES);
+    return centroids;
+}
+
+const std::vector<FeatureCentroid>& suit_feature_centroids() {
+    static const std::vector<FeatureCentroid> centroids = build_feature_centroids(SUIT_TEMPLATES);
+    return centroids;
+}
+
+// Simbol (= 255) iz binarnog isječka; box iz split_corner, ili se komponenta traži ovdje
+std::vector<unsigned char> feature_crop(const std::vector<unsigned char>& img, int width, int height,
+                                        const SymbolBox* box, int& cropW, int& cropH) {
+    return crop_symbol_box(img, width, height, box ? *box : largest_symbol_box(img, width, height), cropW, cropH,
+                           true);
+}
+
+int rankMatcherFeatures(const std::vector<unsigned char>& rankImg, int width, int height, float* margin = nullptr,
+                        const SymbolBox* box = nullptr) {
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = feature_crop(rankImg, width, height, box, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
+        return -1;
+    }
+
+    int bestMatch = classify_features(extract_features(cropped, cropW, cropH), rank_feature_centroids(), "Rank", ~0u,
+                                      margin);
+    LOG_DEBUG("Best match rank: %d", bestMatch);
+    return bestMatch;
+}
+
+int matchSuitFeatures(const std::vector<unsigned char>& suitImg, int width, int height, unsigned candidates = SUIT_ALL,
+                      float* margin = nullptr, const SymbolBox* box = nullptr) {
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = feature_crop(suitImg, width, height, box, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
+        return -1;
+    }
+
+    int bestMatch = classify_features(extract_features(cropped, cropW, cropH), suit_feature_centroids(), "Suit",
+                                      candidates, margin);
+    LOG_DEBUG("Best match suit: %d", bestMatch);
+    return bestMatch;
+}
+
+
+// ---------------------------------------------------------------------------
+// Int8 CNN klasifikator (težine iz cnn_weights.h, generiše ih cnn_train.cpp)
+// ---------------------------------------------------------------------------
+
+// Aktivacije su u opsegu 0..127 (u8), težine int8, pa _mm256_maddubs_epi16
+// (u8 * s8 u parovima) ne može da se zasiti: 2 * 127 * 127 < 32767.
+struct CnnConv {
+    int cin, cout, k, kPad;
+    std::vector<int8_t> w;          // [cout][kPad], dopunjeno nulama
+    const int32_t* bias;
+    const int32_t* mult;
+    const int8_t* shift;
+};
+
+struct CnnModel {
+    CnnConv c1, c2, c3;
+    int featPad;
+    std::vector<int8_t> wd;         // [N_OUT][featPad]
+};
+
+const int CNN_N_OUT = CNN_N_RANK + CNN_N_SUIT;
+const int CNN_FEAT = CNN_C3 * CNN_BANDS_X * CNN_BANDS_Y;
+
+// Dužina reda težina zaokružena na 32 bajta (jedan AVX2 registar)
+int cnn_pad32(int n) { return (n + 31) & ~31; }
+
+CnnConv cnn_make_conv(int cin, int cout, const int8_t* w, const int32_t* bias, const int32_t* mult, const int8_t* shift) {
+    CnnConv c{cin, cout, 9 * cin, cnn_pad32(9 * cin), {}, bias, mult, shift};
+    c.w.assign(cout * c.kPad, 0);
+    for (int co = 0; co < cout; ++co)
+        std::copy(w + co * c.k, w + (co + 1) * c.k, &c.w[co * c.kPad]);
+    return c;
+}
+
+const CnnModel& cnn_model() {
+    static const CnnModel model = [] {
+        CnnModel m{
+            cnn_make_conv(1, CNN_C1, cnn_w1, cnn_b1, cnn_m1, cnn_s1),
+            cnn_make_conv(CNN_C1, CNN_C2, cnn_w2, cnn_b2, cnn_m2, cnn_s2),
+            cnn_make_conv(CNN_C2, CNN_C3, cnn_w3, cnn_b3, cnn_m3, cnn_s3),
+            cnn_pad32(CNN_FEAT), {}
+        };
+        m.wd.assign(CNN_N_OUT * m.featPad, 0);
+        for (int o = 0; o < CNN_N_OUT; ++o)
+            std::copy(cnn_wd + o * CNN_FEAT, cnn_wd + (o + 1) * CNN_FEAT, &m.wd[o * m.featPad]);
+        return m;
+    }();
+    return model;
+}
+
+// Množenje matrice težina [rows][kPad] vektorom okoline: acc[r] = sum(a[i] * w[r][i]).
+// Referentna skalarna verzija.
+void cnn_gemv_scalar(const uint8_t* a, const int8_t* w, int kPad, int rows, int32_t* acc) {
+    for (int r = 0; r < rows; ++r) {
+        const int8_t* wr = w + r * kPad;
+        int32_t sum = 0;
+        for (int i = 0; i < kPad; ++i) sum += (int32_t)a[i] * wr[i];
+        acc[r] = sum;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2: okolina se učitava jednom po bloku od 8 redova težina, a 8 akumulatora
+// se sabira horizontalno zajedno (hadd stablo) na kraju bloka
+__attribute__((target("avx2")))
+void cnn_gemv_avx2(const uint8_t* a, const int8_t* w, int kPad, int rows, int32_t* acc) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    int r = 0;
+    for (; r + 8 <= rows; r += 8) {
+        __m256i s[8];
+        for (int j = 0; j < 8; ++j) s[j] = _mm256_setzero_si256();
+        for (int i = 0; i < kPad; i += 32) {
+            __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+            for (int j = 0; j < 8; ++j) {
+                __m256i vw = _mm256_loadu_si256((const __m256i*)(w + (r + j) * kPad + i));
+                s[j] = _mm256_add_epi32(s[j], _mm256_madd_epi16(_mm256_maddubs_epi16(va, vw), ones));
+            }
+        }
+        __m256i h01 = _mm256_hadd_epi32(s[0], s[1]), h23 = _mm256_hadd_epi32(s[2], s[3]);
+        __m256i h45 = _mm256_hadd_epi32(s[4], s[5]), h67 = _mm256_hadd_epi32(s[6], s[7]);
+        __m256i h0123 = _mm256_hadd_epi32(h01, h23), h4567 = _mm256_hadd_epi32(h45, h67);
+        __m256i lo = _mm256_permute2x128_si256(h0123, h4567, 0x20);
+        __m256i hi = _mm256_permute2x128_si256(h0123, h4567, 0x31);
+        _mm256_storeu_si256((__m256i*)(acc + r), _mm256_add_epi32(lo, hi));
     }
+    for (; r < rows; ++r) {
+        __m256i s = _mm256_setzero_si256();
+        for (int i = 0; i < kPad; i += 32) {
+            __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+            __m256i vw = _mm256_loadu_si256((const __m256i*)(w + r * kPad + i));
+            s = _mm256_add_epi32(s, _mm256_madd_epi16(_mm256_maddubs_epi16(va, vw), ones));
+        }
+        __m128i t = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        t = _mm_add_epi32(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(1, 0, 3, 2)));
+        t = _mm_add_epi32(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1)));
+        acc[r] = _mm_cvtsi128_si32(t);
+    }
+}
+#else
+void cnn_gemv_avx2(const uint8_t* a, const int8_t* w, int kPad, int rows, int32_t* acc) {
+    cnn_gemv_scalar(a, w, kPad, rows, acc);
+}
+#endif
 
-    // 4. Find corners
-    auto corners = find_corners(largest);
-
-    // 5. Mark corners on image
-    std::vector<unsigned char> cornerImage(image, image + width * height * 3);
-    for (auto& c : corners) {
-        int xx = (int)c.x, yy = (int)c.y;
-        for (int dy = -5; dy <= 5; ++dy) {
-            for (int dx = -5; dx <= 5; ++dx) {
-                int nx = xx + dx, ny = yy + dy;
-                if (nx >= 0 && ny >= 0 && nx < width && ny < height) {
-                    int idx = (ny * width + nx) * 3;
-                    cornerImage[idx] = 255;
-                    cornerImage[idx + 1] = 0;
-                    cornerImage[idx + 2] = 0;
+using CnnGemvFn = void (*)(const uint8_t*, const int8_t*, int, int, int32_t*);
+
+// (acc + bias) * mult >> shift sa zaokruživanjem, ReLU i odsijecanje na 127
+inline uint8_t cnn_requantize(int32_t acc, int32_t bias, int32_t mult, int shift) {
+    int64_t v = (int64_t)(acc + bias) * mult;
+    v = (v + ((int64_t)1 << (shift - 1))) >> shift;
+    return (uint8_t)std::clamp<int64_t>(v, 0, 127);
+}
+
+// Konvolucija 3x3 (padding 1) + ReLU + maxpool 2x2, HWC raspored
+void cnn_conv_pool(const CnnConv& c, const uint8_t* in, int W, int H, std::vector<uint8_t>& out, CnnGemvFn gemv) {
+    const int OW = W / 2, OH = H / 2;
+    out.assign(OW * OH * c.cout, 0);
+
+    // Ulaz sa okvirom od nula: red 3x3 okoline je tada kontinualnih 3 * cin bajtova
+    const int PW = W + 2, rowBytes = 3 * c.cin;
+    std::vector<uint8_t> padded((H + 2) * PW * c.cin, 0);
+    for (int y = 0; y < H; ++y)
+        std::memcpy(&padded[((y + 1) * PW + 1) * c.cin], in + y * W * c.cin, W * c.cin);
+
+    std::vector<uint8_t> patch(c.kPad, 0);
+    std::vector<uint8_t> row(2 * W * c.cout);   // dva reda konvolucije prije pool-a
+    std::vector<int32_t> acc(c.cout);
+
+    for (int oy = 0; oy < OH; ++oy) {
+        for (int r = 0; r < 2; ++r) {
+            int y = 2 * oy + r;
+            for (int x = 0; x < 2 * OW; ++x) {
+                for (int ky = 0; ky < 3; ++ky) {
+                    const uint8_t* src = &padded[((y + ky) * PW + x) * c.cin];
+                    uint8_t* dst = &patch[ky * rowBytes];
+                    for (int i = 0; i < rowBytes; ++i) dst[i] = src[i];
                 }
+                gemv(patch.data(), c.w.data(), c.kPad, c.cout, acc.data());
+                uint8_t* o = &row[(r * W + x) * c.cout];
+                for (int co = 0; co < c.cout; ++co)
+                    o[co] = cnn_requantize(acc[co], c.bias[co], c.mult[co], c.shift[co]);
             }
         }
+        for (int ox = 0; ox < OW; ++ox)
+            for (int co = 0; co < c.cout; ++co) {
+                uint8_t m = std::max(std::max(row[(2 * ox) * c.cout + co], row[(2 * ox + 1) * c.cout + co]),
+                                     std::max(row[(W + 2 * ox) * c.cout + co], row[(W + 2 * ox + 1) * c.cout + co]));
+                out[(oy * OW + ox) * c.cout + co] = m;
+            }
     }
-    save_image("step4_corners.jpg", cornerImage, width, height);
+}
 
-    // 6. Warp perspective
-    auto warped = warp_image(image, width, height, corners, 200, 300);
-    save_image("step5_warped.jpg", warped, 200, 300);
+#if defined(__x86_64__) || defined(__i386__)
+// Prvi sloj (cin = 1) ima okolinu od samo 9 bajtova, pa se umjesto po kanalima
+// vektorizuje po x: 8 susjednih izlaza jednog kanala odjednom, sa vektorskom
+// rekvantizacijom (isti rezultat kao cnn_requantize)
+__attribute__((target("avx2")))
+void cnn_conv1_pool_avx2(const CnnConv& c, const uint8_t* in, int W, int H, std::vector<uint8_t>& out) {
+    const int OW = W / 2, OH = H / 2;
+    out.assign(OW * OH * c.cout, 0);
+
+    const int XB = (W + 7) & ~7;          // izlazi po redu, zaokruženo na 8
+    const int PW = XB + 16;               // učitavanja od 8 bajtova ostaju u baferu
+    std::vector<uint8_t> padded((H + 2) * PW, 0);
+    for (int y = 0; y < H; ++y)
+        std::memcpy(&padded[(y + 1) * PW + 1], in + y * W, W);
+
+    std::vector<uint8_t> conv(2 * c.cout * XB);   // [red][kanal][x]
+    const __m256i zero = _mm256_setzero_si256(), maxAct = _mm256_set1_epi32(127);
+
+    for (int oy = 0; oy < OH; ++oy) {
+        for (int r = 0; r < 2; ++r) {
+            const uint8_t* rows = &padded[(2 * oy + r) * PW];
+            for (int co = 0; co < c.cout; ++co) {
+                __m256i w[9];
+                for (int i = 0; i < 9; ++i) w[i] = _mm256_set1_epi32(c.w[co * c.kPad + i]);
+                const __m256i bias = _mm256_set1_epi32(c.bias[co]), mult = _mm256_set1_epi32(c.mult[co]);
+                const __m256i round = _mm256_set1_epi64x(1LL << (c.shift[co] - 1));
+                const __m128i shift = _mm_cvtsi32_si128(c.shift[co]);
+                uint8_t* dst = &conv[(r * c.cout + co) * XB];
+
+                for (int x0 = 0; x0 < XB; x0 += 8) {
+                    __m256i acc = zero;
+                    for (int ky = 0; ky < 3; ++ky)
+                        for (int kx = 0; kx < 3; ++kx) {
+                            __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(rows + ky * PW + x0 + kx)));
+                            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(v, w[ky * 3 + kx]));
+                        }
 
-    // 7. Extract top-left corner
-    save_top_left_corner(warped, 200, 300, 33, 90, "step6_corner_topleft.png");
-    
-    // 8. Process corner image
-    int tlw, tlh, tlch;
-    unsigned char* cornerImg = stbi_load("step6_corner_topleft.png", &tlw, &tlh, &tlch, 3);
-    if (!cornerImg) {
-        std::cerr << "Greska pri ucitavanju step6_corner_topleft.png!" << std::endl;
-        stbi_image_free(image);
-        return 1;
+                    // ReLU prije množenja ne mijenja rezultat (mult > 0), a dozvoljava logički shift
+                    __m256i v = _mm256_max_epi32(_mm256_add_epi32(acc, bias), zero);
+                    __m256i even = _mm256_srl_epi64(_mm256_add_epi64(_mm256_mul_epu32(v, mult), round), shift);
+                    __m256i odd = _mm256_srl_epi64(_mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(v, 32), mult), round), shift);
+                    __m256i res = _mm256_min_epi32(_mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA), maxAct);
+
+                    __m128i p16 = _mm_packus_epi32(_mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1));
+                    _mm_storel_epi64((__m128i*)(dst + x0), _mm_packus_epi16(p16, p16));
+                }
+            }
+        }
+        for (int ox = 0; ox < OW; ++ox)
+            for (int co = 0; co < c.cout; ++co) {
+                const uint8_t* r0 = &conv[co * XB + 2 * ox];
+                const uint8_t* r1 = &conv[(c.cout + co) * XB + 2 * ox];
+                out[(oy * OW + ox) * c.cout + co] = std::max(std::max(r0[0], r0[1]), std::max(r1[0], r1[1]));
+            }
+    }
+}
+#endif
+
+// Ugao RGB (CNN_IN_W x CNN_IN_H) -> invertovan grayscale razvučen na 0..127
+std::vector<uint8_t> cnn_prepare_input(const std::vector<unsigned char>& cornerRGB) {
+    std::vector<unsigned char> gray(CNN_IN_W * CNN_IN_H);
+    for (int i = 0; i < CNN_IN_W * CNN_IN_H; ++i) {
+        const unsigned char* px = &cornerRGB[i * 3];
+        gray[i] = static_cast<unsigned char>(0.299 * px[0] + 0.587 * px[1] + 0.114 * px[2]);
     }
+    int lo = 255, hi = 0;
+    for (unsigned char v : gray) { lo = std::min<int>(lo, v); hi = std::max<int>(hi, v); }
+    int range = std::max(1, hi - lo);
+    std::vector<uint8_t> q(gray.size());
+    for (size_t i = 0; i < gray.size(); ++i) q[i] = (uint8_t)((hi - gray[i]) * 127 / range);
+    return q;
+}
 
-    // 9. Convert corner to grayscale
-    std::vector<unsigned char> grayTL(tlw * tlh);
-    for (int y = 0; y < tlh; ++y) {
-        for (int x = 0; x < tlw; ++x) {
-            int idx = (y * tlw + x) * 3;
-            unsigned char r = cornerImg[idx], g = cornerImg[idx + 1], b = cornerImg[idx + 2];
-            grayTL[y * tlw + x] = static_cast<unsigned char>(0.299 * r + 0.587 * g + 0.114 * b);
+// Jedan prolaz mreže: logits[0..12] za rank, logits[13..16] za suit
+void cnn_infer(const std::vector<uint8_t>& input, int32_t* logits, bool useAvx2) {
+    const CnnModel& m = cnn_model();
+    const bool avx2 = useAvx2 && cpu_has_avx2();
+    CnnGemvFn gemv = avx2 ? cnn_gemv_avx2 : cnn_gemv_scalar;
+
+    std::vector<uint8_t> a1, a2, a3;
+    int W = CNN_IN_W, H = CNN_IN_H;
+#if defined(__x86_64__) || defined(__i386__)
+    if (avx2)
+        cnn_conv1_pool_avx2(m.c1, input.data(), W, H, a1);
+    else
+#endif
+        cnn_conv_pool(m.c1, input.data(), W, H, a1, gemv);
+    W /= 2; H /= 2;
+    cnn_conv_pool(m.c2, a1.data(), W, H, a2, gemv);
+    W /= 2; H /= 2;
+    cnn_conv_pool(m.c3, a2.data(), W, H, a3, gemv);
+    W /= 2; H /= 2;
+
+    // Max-pool po trakama (BANDS_Y x BANDS_X oblasti)
+    std::vector<uint8_t> feat(m.featPad, 0);
+    for (int by = 0; by < CNN_BANDS_Y; ++by)
+        for (int bx = 0; bx < CNN_BANDS_X; ++bx) {
+            uint8_t* f = &feat[(by * CNN_BANDS_X + bx) * CNN_C3];
+            for (int y = by * H / CNN_BANDS_Y; y < (by + 1) * H / CNN_BANDS_Y; ++y)
+                for (int x = bx * W / CNN_BANDS_X; x < (bx + 1) * W / CNN_BANDS_X; ++x)
+                    for (int c = 0; c < CNN_C3; ++c) f[c] = std::max(f[c], a3[(y * W + x) * CNN_C3 + c]);
         }
+
+    gemv(feat.data(), m.wd.data(), m.featPad, CNN_N_OUT, logits);
+    for (int o = 0; o < CNN_N_OUT; ++o) logits[o] += cnn_bd[o];
+}
+
+// Razlika dva najveća logita u odnosu na najveći (1 ako je drugi negativan ili ga nema)
+float cnn_margin(const int32_t* logits, int n, unsigned mask) {
+    int64_t best = INT64_MIN, second = INT64_MIN;
+    for (int i = 0; i < n; ++i) {
+        if (!(mask & (1u << i))) continue;
+        if (logits[i] > best) { second = best; best = logits[i]; }
+        else if (logits[i] > second) second = logits[i];
     }
+    if (best <= 0) return 0.0f;
+    if (second <= 0) return 1.0f;
+    return (float)(best - second) / (float)best;
+}
 
-    // 10. Binarize corner image
-    auto binaryTL = binarize_image(grayTL, tlw, tlh, 100);
+// Vraća rank u kodiranju putTextString (1..13) i suit (0..3)
+// Suit se bira samo među kandidatima iz maske boje
+void cnnClassify(const std::vector<unsigned char>& cornerRGB, int& rank, int& suit, bool useAvx2 = true,
+                 unsigned candidates = SUIT_ALL, float* rankMargin = nullptr, float* suitMargin = nullptr) {
+    int32_t logits[CNN_N_OUT];
+    cnn_infer(cnn_prepare_input(cornerRGB), logits, useAvx2);
+    rank = 1 + (int)(std::max_element(logits, logits + CNN_N_RANK) - logits);
+    suit = -1;
+    for (int s = 0; s < CNN_N_SUIT; ++s)
+        if ((candidates & (1u << s)) && (suit < 0 || logits[CNN_N_RANK + s] > logits[CNN_N_RANK + suit])) suit = s;
+    if (rankMargin) *rankMargin = cnn_margin(logits, CNN_N_RANK, ~0u);
+    if (suitMargin) *suitMargin = cnn_margin(logits + CNN_N_RANK, CNN_N_SUIT, candidates);
+}
 
-    // 11. Find symbol area
-    std::vector<Point2f> symbolPoints;
-    for (int y = 0; y < tlh; ++y) {
-        for (int x = 0; x < tlw; ++x) {
-            if (binaryTL[y * tlw + x] == 0) { // znak i broj su crni
-                symbolPoints.push_back({(float)x, (float)y});
+
+// ---------------------------------------------------------------------------
+// Batch template matcher nad bit-pakovanim slikama: N normalizovanih isječaka
+// se poredi sa svim šablonima jednog skupa u jednom blokiranom kernelu
+// (pločice PACK_TILE_C isječaka x PACK_TILE_T šablona, kao mali GEMM).
+// Rezultat je isti broj različitih piksela kao kod rankMatcher/matchSuit.
+// ---------------------------------------------------------------------------
+
+const int PACK_TILE_C = 4;  // isječaka po pločici
+const int PACK_TILE_T = 4;  // šablona po pločici
+const size_t BATCH_MATCH_SIZE = 64; // karata po batch-u u --matcher=template-batch
+
+// Šabloni jednog skupa, svi iste veličine; red slike počinje na granici riječi
+struct PackedTemplates {
+    int width = 0, height = 0;
+    int rowWords = 0, words = 0;         // 64-bitnih riječi po redu / po slici
+    std::vector<int> labels;
+    std::vector<uint64_t> bits;          // labels.size() x words, bit = piksel 255
+};
+
+PackedTemplates pack_templates(const std::vector<std::pair<std::string, int>>& templates) {
+    const TemplateSet set = load_template_set(templates);
+    PackedTemplates bank;
+    const int w = set.width, h = set.height;
+    bank.width = w;
+    bank.height = h;
+    bank.rowWords = (w + 63) / 64;
+    bank.words = bank.rowWords * h;
+    bank.labels = set.labels;
+    bank.bits.assign(bank.labels.size() * bank.words, 0);
+    for (size_t i = 0; i < set.gray.size(); ++i) {
+        std::vector<unsigned char> bin = binarize(set.gray[i].data(), w, h, 1);
+        uint64_t* t = &bank.bits[i * bank.words];
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                if (bin[y * w + x] == 255) t[y * bank.rowWords + x / 64] |= 1ull << (x % 64);
+    }
+    return bank;
+}
+
+// Isječak veličine šablona kao dvije ravni: X = (p != 255) ^ (p != 0) i B = (p != 0).
+// Razlika sa šablonom T je popcount(((X & T) ^ B)): za T = 1 daje p != 255, za T = 0 p != 0,
+// pa se i međuvrijednosti bilinearnog resize-a broje kao razlika, kao u matchSuit.
+void pack_crop(const unsigned char* img, const PackedTemplates& bank, uint64_t* X, uint64_t* B) {
+    std::fill(X, X + bank.words, 0);
+    std::fill(B, B + bank.words, 0);
+    for (int y = 0; y < bank.height; ++y)
+        for (int x = 0; x < bank.width; ++x) {
+            unsigned char v = img[y * bank.width + x];
+            uint64_t bit = 1ull << (x % 64);
+            int i = y * bank.rowWords + x / 64;
+            if ((v != 255) != (v != 0)) X[i] |= bit;
+            if (v != 0) B[i] |= bit;
+        }
+}
+
+// Jedna pločica: akumulatori ostaju u registrima, a riječi šablona se čitaju
+// jednom po pločici isječaka
+template <int TC, int TT>
+__attribute__((always_inline)) inline void packed_tile(const uint64_t* X, const uint64_t* B, const uint64_t* T,
+                                                       int words, int* scores, int nTemplates) {
+    int acc[TC][TT] = {};
+    for (int k = 0; k < words; ++k) {
+        uint64_t t[TT];
+        for (int j = 0; j < TT; ++j) t[j] = T[j * words + k];
+        for (int i = 0; i < TC; ++i) {
+            uint64_t x = X[i * words + k], b = B[i * words + k];
+            for (int j = 0; j < TT; ++j) acc[i][j] += __builtin_popcountll((x & t[j]) ^ b);
+        }
+    }
+    for (int i = 0; i < TC; ++i)
+        for (int j = 0; j < TT; ++j) scores[i * nTemplates + j] = acc[i][j];
+}
+
+// scores[n x nTemplates]; X i B su n x words
+__attribute__((always_inline)) inline void packed_scores_impl(const PackedTemplates& bank, const uint64_t* X,
+                                                              const uint64_t* B, int n, int* scores) {
+    const int nt = (int)bank.labels.size(), words = bank.words;
+    for (int c = 0; c < n; c += PACK_TILE_C) {
+        for (int t = 0; t < nt; t += PACK_TILE_T) {
+            const uint64_t* tp = &bank.bits[(size_t)t * words];
+            const uint64_t* xp = X + (size_t)c * words;
+            const uint64_t* bp = B + (size_t)c * words;
+            int* sp = scores + (size_t)c * nt + t;
+            if (c + PACK_TILE_C <= n && t + PACK_TILE_T <= nt) {
+                packed_tile<PACK_TILE_C, PACK_TILE_T>(xp, bp, tp, words, sp, nt);
+            } else {
+                // Ivične pločice
+                for (int i = 0; i < std::min(PACK_TILE_C, n - c); ++i)
+                    for (int j = 0; j < std::min(PACK_TILE_T, nt - t); ++j)
+                        packed_tile<1, 1>(xp + (size_t)i * words, bp + (size_t)i * words, tp + (size_t)j * words,
+                                          words, sp + (size_t)i * nt + j, nt);
             }
         }
     }
+}
 
-    if (symbolPoints.empty()) {
-        std::cerr << "Nema detektovanih simbola!" << std::endl;
-        stbi_image_free(cornerImg);
-        stbi_image_free(image);
-        return 1;
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("popcnt"))) void packed_scores_popcnt(const PackedTemplates& bank, const uint64_t* X,
+                                                            const uint64_t* B, int n, int* scores) {
+    packed_scores_impl(bank, X, B, n, scores);
+}
+
+bool cpu_has_popcnt() {
+    static const bool has = __builtin_cpu_supports("popcnt");
+    return has;
+}
+#endif
+
+void packed_scores(const PackedTemplates& bank, const uint64_t* X, const uint64_t* B, int n, int* scores) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has_popcnt()) {
+        packed_scores_popcnt(bank, X, B, n, scores);
+        return;
     }
+#endif
+    packed_scores_impl(bank, X, B, n, scores);
+}
 
-    // 12. Crop symbol area
-    float minX = tlw, minY = tlh, maxX = 0, maxY = 0;
-    for (const auto& p : symbolPoints) {
-        minX = std::min(minX, p.x);
-        minY = std::min(minY, p.y);
-        maxX = std::max(maxX, p.x);
-        maxY = std::max(maxY, p.y);
+// Najbolji šablon (kao u rankMatcher: prvi sa najmanjom razlikom) među kandidatima
+int packed_best(const PackedTemplates& bank, const int* scores, unsigned candidates, float* margin) {
+    int best = -1, minDiff = INT_MAX, secondDiff = INT_MAX;
+    for (size_t j = 0; j < bank.labels.size(); ++j) {
+        if (!(candidates & (1u << bank.labels[j]))) continue;
+        if (scores[j] < minDiff) {
+            secondDiff = minDiff;
+            minDiff = scores[j];
+            best = bank.labels[j];
+        } else if (scores[j] < secondDiff) {
+            secondDiff = scores[j];
+        }
     }
+    if (margin) *margin = match_margin((float)minDiff, secondDiff == INT_MAX ? 1e30f : (float)secondDiff);
+    return best;
+}
 
-    int cropW = (int)(maxX - minX + 1);
-    int cropH = (int)(maxY - minY + 1);
+const PackedTemplates& packed_rank_templates() {
+    static const PackedTemplates bank = pack_templates(RANK_TEMPLATES);
+    return bank;
+}
 
-    std::vector<unsigned char> finalCrop(cropW * cropH * 3);
-    for (int y = 0; y < cropH; ++y) {
-        for (int x = 0; x < cropW; ++x) {
-            for (int c = 0; c < 3; ++c) {
-                finalCrop[(y * cropW + x) * 3 + c] =
-                    cornerImg[((int)minY + y) * tlw * 3 + ((int)minX + x) * 3 + c];
+const PackedTemplates& packed_suit_templates() {
+    static const PackedTemplates bank = pack_templates(SUIT_TEMPLATES);
+    return bank;
+}
+
+// Isječak ranka normalizovan kao u rankMatcher (najbliži susjed na veličinu šablona);
+// prazan ako nema komponente
+std::vector<unsigned char> normalize_rank_crop(const std::vector<unsigned char>& rankImg, int width, int height,
+                                               const PackedTemplates& bank) {
+    std::vector<unsigned char> inverted(rankImg.size());
+    for (size_t i = 0; i < rankImg.size(); ++i) inverted[i] = 255 - rankImg[i];
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = crop_largest_component(inverted, width, height, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
+        return cropped;
+    }
+    if (debug_enabled()) debug_image("_debug_cropped_rank.png", cropW, cropH, 1, cropped);
+
+    std::vector<unsigned char> resized(bank.width * bank.height);
+    float xRatio = (float)cropW / bank.width;
+    float yRatio = (float)cropH / bank.height;
+    for (int y = 0; y < bank.height; y++)
+        for (int x = 0; x < bank.width; x++)
+            resized[y * bank.width + x] = cropped[(int)(y * yRatio) * cropW + (int)(x * xRatio)];
+    return resized;
+}
+
+// Isječak suita normalizovan kao u matchSuit (bilinearno na veličinu šablona)
+std::vector<unsigned char> normalize_suit_crop(const std::vector<unsigned char>& suitImg, int width, int height,
+                                               const PackedTemplates& bank) {
+    std::vector<unsigned char> inverted(suitImg.size());
+    for (size_t i = 0; i < suitImg.size(); ++i) inverted[i] = 255 - suitImg[i];
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = crop_largest_component(inverted, width, height, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
+        return cropped;
+    }
+    if (debug_enabled()) debug_image("_debug_cropped_suit.png", cropW, cropH, 1, cropped);
+    std::vector<unsigned char> resized = bilinear_resize(cropped, cropW, cropH, bank.width, bank.height);
+    if (debug_enabled()) debug_image("_debug_resized_suit.png", bank.width, bank.height, 1, resized);
+    return resized;
+}
+
+// Batch poređenje: crops su normalizovani isječci (prazan = nema simbola),
+// candidates maska labela po isječku; best = -1 za prazne isječke
+void packed_match_batch(const PackedTemplates& bank, const std::vector<std::vector<unsigned char>>& crops,
+                        const std::vector<unsigned>& candidates, std::vector<int>& best, std::vector<float>& margins) {
+    const size_t nt = bank.labels.size();
+    std::vector<size_t> index;
+    for (size_t i = 0; i < crops.size(); ++i)
+        if (!crops[i].empty()) index.push_back(i);
+
+    std::vector<uint64_t> X(index.size() * bank.words), B(index.size() * bank.words);
+    for (size_t i = 0; i < index.size(); ++i)
+        pack_crop(crops[index[i]].data(), bank, &X[i * bank.words], &B[i * bank.words]);
+    std::vector<int> scores(index.size() * nt);
+    if (!index.empty()) packed_scores(bank, X.data(), B.data(), (int)index.size(), scores.data());
+
+    best.assign(crops.size(), -1);
+    margins.assign(crops.size(), 0.0f);
+    for (size_t i = 0; i < index.size(); ++i)
+        best[index[i]] = packed_best(bank, &scores[i * nt], candidates[index[i]], &margins[index[i]]);
+}
+
+
+// ---------------------------------------------------------------------------
+// Template matcher sa pomakom (--matcher=template-shift): svaki šablon se poredi
+// sa isječkom pomjerenim za -k..k piksela po x i y i uzima se najmanja razlika.
+// Isječak je tijesni bbox bez paddinga; pomak po x je šift bit-redova preko
+// granice riječi, pomak po y samo pomjera indeks reda.
+// ---------------------------------------------------------------------------
+
+const int SHIFT_MAX = 8;      // najveći dozvoljeni --shift
+const int SHIFT_DEFAULT = 2;
+
+// Tijesni bbox najveće komponente (uključujući posljednji red i kolonu); false ako je nema
+bool largest_component_bbox(const std::vector<unsigned char>& img, int width, int height, int& minX, int& minY,
+                            int& cropW, int& cropH) {
+    cropW = cropH = 0;
+    std::vector<Point2f> largest = find_largest_component(img, width, height);
+    if (largest.empty()) return false;
+
+    int maxX = 0, maxY = 0;
+    minX = width;
+    minY = height;
+    for (const auto& p : largest) {
+        minX = std::min(minX, (int)p.x);
+        maxX = std::max(maxX, (int)p.x);
+        minY = std::min(minY, (int)p.y);
+        maxY = std::max(maxY, (int)p.y);
+    }
+    cropW = maxX - minX + 1;
+    cropH = maxY - minY + 1;
+    return true;
+}
+
+std::vector<unsigned char> crop_component_tight(const std::vector<unsigned char>& img, int width, int height,
+                                                int& cropW, int& cropH) {
+    int minX, minY;
+    if (!largest_component_bbox(img, width, height, minX, minY, cropW, cropH)) return {};
+    std::vector<unsigned char> cropped(cropW * cropH);
+    for (int y = 0; y < cropH; y++)
+        for (int x = 0; x < cropW; x++) cropped[y * cropW + x] = img[(y + minY) * width + x + minX];
+    return cropped;
+}
+
+// Binarni isječak (simbol = 255) najbližim susjedom na veličinu šablona i pakovan po redovima
+std::vector<uint64_t> pack_tight_crop(const std::vector<unsigned char>& binaryImg, int width, int height,
+                                      const PackedTemplates& bank, const char* debugName) {
+    std::vector<unsigned char> inverted(binaryImg.size());
+    for (size_t i = 0; i < binaryImg.size(); ++i) inverted[i] = 255 - binaryImg[i];
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = crop_component_tight(inverted, width, height, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
+        return {};
+    }
+    if (debug_enabled()) debug_image(debugName, cropW, cropH, 1, cropped);
+
+    std::vector<uint64_t> bits(bank.words, 0);
+    for (int y = 0; y < bank.height; y++)
+        for (int x = 0; x < bank.width; x++) {
+            int srcX = x * cropW / bank.width, srcY = y * cropH / bank.height;
+            if (cropped[srcY * cropW + srcX] >= 128) bits[y * bank.rowWords + x / 64] |= 1ull << (x % 64);
+        }
+    return bits;
+}
+
+// Red pomjeren za dx piksela (dx > 0 udesno); ispražnjeni pikseli su pozadina
+void shift_row(const uint64_t* in, uint64_t* out, int rowWords, int dx, uint64_t lastMask) {
+    for (int i = 0; i < rowWords; ++i) {
+        if (dx > 0) {
+            out[i] = (in[i] << dx) | (i > 0 ? in[i - 1] >> (64 - dx) : 0);
+        } else if (dx < 0) {
+            out[i] = (in[i] >> -dx) | (i + 1 < rowWords ? in[i + 1] << (64 + dx) : 0);
+        } else {
+            out[i] = in[i];
+        }
+    }
+    out[rowWords - 1] &= lastMask;
+}
+
+// Pomaci poređani po udaljenosti od (0, 0): pri jednakoj razlici pobjeđuje manji pomak,
+// a dobar rezultat rano daje prag za prekid ostalih
+const std::vector<std::pair<int, int>>& shift_offsets(int k) {
+    static std::vector<std::pair<int, int>> offsets[SHIFT_MAX + 1];
+    static std::once_flag once[SHIFT_MAX + 1];
+    std::call_once(once[k], [k]() {
+        for (int dy = -k; dy <= k; ++dy)
+            for (int dx = -k; dx <= k; ++dx) offsets[k].push_back({dx, dy});
+        std::stable_sort(offsets[k].begin(), offsets[k].end(), [](const auto& a, const auto& b) {
+            return std::abs(a.first) + std::abs(a.second) < std::abs(b.first) + std::abs(b.second);
+        });
+    });
+    return offsets[k];
+}
+
+// scores[j] = najmanja razlika šablona j preko svih pomaka; shifted su 2k+1 verzija
+// isječka pomjerenih po x. Pikseli isječka pomjereni van okvira se ne broje;
+// pomak se prekida čim pređe dosadašnji minimum šablona.
+__attribute__((always_inline)) inline void shift_scores_impl(const PackedTemplates& bank, const uint64_t* shifted,
+                                                             int k, unsigned candidates, int* scores) {
+    const int rw = bank.rowWords, h = bank.height;
+    const auto& offsets = shift_offsets(k);
+    for (size_t j = 0; j < bank.labels.size(); ++j) {
+        scores[j] = INT_MAX;
+        if (!(candidates & (1u << bank.labels[j]))) continue;
+        const uint64_t* T = &bank.bits[j * bank.words];
+        int best = INT_MAX;
+        for (const auto& [dx, dy] : offsets) {
+            const uint64_t* C = shifted + (size_t)(dx + k) * bank.words;
+            int diff = 0;
+            for (int y = 0; y < h && diff < best; ++y) {
+                int sy = y - dy;
+                const uint64_t* t = T + y * rw;
+                if (sy < 0 || sy >= h) {
+                    for (int i = 0; i < rw; ++i) diff += __builtin_popcountll(t[i]);
+                } else {
+                    const uint64_t* c = C + sy * rw;
+                    for (int i = 0; i < rw; ++i) diff += __builtin_popcountll(t[i] ^ c[i]);
+                }
             }
+            if (diff < best) best = diff;
         }
+        scores[j] = best;
     }
+}
 
-    stbi_write_png("step7_symbol_crop.png", cropW, cropH, 3, finalCrop.data(), cropW * 3);
-    
-    // 13. Split symbol into rank and suit
-    split_symbol_image("step7_symbol_crop.png");
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("popcnt"))) void shift_scores_popcnt(const PackedTemplates& bank, const uint64_t* shifted,
+                                                           int k, unsigned candidates, int* scores) {
+    shift_scores_impl(bank, shifted, k, candidates, scores);
+}
+#endif
 
-    // 14. Load and prepare rank image for matching
-    int rank_width, rank_height;
-    std::vector<unsigned char> rank_img = load_image_grayscale("broj.png", rank_width, rank_height);
-    auto binary_rank = binarize_image(rank_img, rank_width, rank_height, 120);
+void shift_scores(const PackedTemplates& bank, const uint64_t* shifted, int k, unsigned candidates, int* scores) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_has_popcnt()) {
+        shift_scores_popcnt(bank, shifted, k, candidates, scores);
+        return;
+    }
+#endif
+    shift_scores_impl(bank, shifted, k, candidates, scores);
+}
 
+// Najbolji šablon za binarnu sliku ranka ili suita uz pomak do k piksela; -1 ako nema simbola
+int shift_matcher(const PackedTemplates& bank, const std::vector<unsigned char>& binaryImg, int width, int height,
+                  int k, unsigned candidates, const char* debugName, float* margin) {
+    std::vector<uint64_t> crop = pack_tight_crop(binaryImg, width, height, bank, debugName);
+    if (crop.empty()) return -1;
+
+    const int rw = bank.rowWords;
+    const uint64_t lastMask = (bank.width % 64) ? (1ull << (bank.width % 64)) - 1 : ~0ull;
+    std::vector<uint64_t> shifted((size_t)(2 * k + 1) * bank.words);
+    for (int dx = -k; dx <= k; ++dx)
+        for (int y = 0; y < bank.height; ++y)
+            shift_row(&crop[y * rw], &shifted[(size_t)(dx + k) * bank.words + y * rw], rw, dx, lastMask);
+
+    std::vector<int> scores(bank.labels.size());
+    shift_scores(bank, shifted.data(), k, candidates, scores.data());
+    for (size_t j = 0; j < bank.labels.size(); ++j)
+        if (scores[j] != INT_MAX) LOG_DEBUG(" -> %d has shifted diff: %d", bank.labels[j], scores[j]);
+    return packed_best(bank, scores.data(), candidates, margin);
+}
 
-// 14. Load and prepare rank image for matching
-    int suit_width, suit_height;
-    std::vector<unsigned char> suit_img = load_image_grayscale("znak.png", suit_width, suit_height);
-    auto binary_suit = binarize_image(suit_img, suit_width, suit_height, 120);
+int rankMatcherShift(const std::vector<unsigned char>& rankImg, int width, int height, int k,
+                     float* margin = nullptr) {
+    int best = shift_matcher(packed_rank_templates(), rankImg, width, height, k, ~0u, "_debug_cropped_rank.png",
+                             margin);
+    LOG_DEBUG("Best match rank: %d", best);
+    return best;
+}
 
-    // 15. Match rank
-    // U main funkciji, nakon što dobijete binarnu sliku ranka:
-int rank = rankMatcher(binary_rank, rank_width, rank_height);
-if (rank != -1) {
-    std::cout << "Detektovani rank: " << putTextString(rank) << std::endl;
+int matchSuitShift(const std::vector<unsigned char>& suitImg, int width, int height, int k,
+                   unsigned candidates = 0xF, float* margin = nullptr) {
+    int best = shift_matcher(packed_suit_templates(), suitImg, width, height, k, candidates,
+                             "_debug_cropped_suit.png", margin);
+    LOG_DEBUG("Best match suit: %d", best);
+    return best;
 }
 
-   // 16. Match suit
-    int suit_code = matchSuit(binary_suit, suit_width, suit_height);
-    if (suit_code != -1) {
-        std::cout << "Detektovani suit: " << suitToString(suit_code) << std::endl;
-    } else {
-        std::cout << "Suit nije prepoznat!" << std::endl;
+
+// ---------------------------------------------------------------------------
+// Sivi matcher (--matcher=gray-sad / gray-ncc): isječak simbola se ne binarizuje,
+// nego se sivi pikseli (simbol svijetao) razvuku na 0..255 i porede sa sivim
+// šablonima preko sume apsolutnih razlika (psadbw) ili normalizovane
+// kros-korelacije sa unaprijed izračunatom srednjom vrijednošću i normom šablona.
+// ---------------------------------------------------------------------------
+
+enum class GrayMetric { Sad, Ncc };
+
+struct GrayTemplates {
+    int width = 0, height = 0;
+    size_t stride = 0;                  // bajtova po šablonu, poravnato na 32 (ostatak su nule)
+    std::vector<int> labels;
+    std::vector<unsigned char> pixels;  // labels.size() x stride
+    std::vector<double> sum, norm;      // suma piksela i sqrt(sum (t - mean)^2) po šablonu
+};
+
+// Linearno razvlači vrijednosti na 0..255 (kontrast nezavisan od osvjetljenja)
+void stretch_contrast(unsigned char* px, size_t n) {
+    if (n == 0) return;
+    auto [lo, hi] = std::minmax_element(px, px + n);
+    int mn = *lo, range = *hi - *lo;
+    if (range == 0) return;
+    for (size_t i = 0; i < n; ++i) px[i] = (unsigned char)((px[i] - mn) * 255 / range);
+}
+
+GrayTemplates load_gray_templates(const std::vector<std::pair<std::string, int>>& templates) {
+    const TemplateSet set = load_template_set(templates);
+    GrayTemplates bank;
+    const int w = set.width, h = set.height;
+    bank.width = w;
+    bank.height = h;
+    bank.stride = ((size_t)w * h + 31) & ~(size_t)31;
+    bank.labels = set.labels;
+    for (const auto& tpl : set.gray) {
+        std::vector<unsigned char> gray(bank.stride, 0);
+        std::copy(tpl.begin(), tpl.end(), gray.begin());
+        stretch_contrast(gray.data(), (size_t)w * h);
+
+        double sum = 0, sumSq = 0;
+        for (int i = 0; i < w * h; ++i) {
+            sum += gray[i];
+            sumSq += (double)gray[i] * gray[i];
+        }
+        bank.pixels.insert(bank.pixels.end(), gray.begin(), gray.end());
+        bank.sum.push_back(sum);
+        bank.norm.push_back(std::sqrt(std::max(0.0, sumSq - sum * sum / (w * h))));
     }
+    return bank;
+}
 
-    stbi_image_free(cornerImg);
-    stbi_image_free(image);
-    
-    return 0;
+const GrayTemplates& gray_rank_templates() {
+    static const GrayTemplates bank = load_gray_templates(RANK_TEMPLATES);
+    return bank;
+}
+
+const GrayTemplates& gray_suit_templates() {
+    static const GrayTemplates bank = load_gray_templates(SUIT_TEMPLATES);
+    return bank;
+}
+
+uint32_t sad_u8_scalar(const unsigned char* a, const unsigned char* b, size_t n) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += std::abs(a[i] - b[i]);
+    return sum;
+}
+
+uint64_t dot_u8_scalar(const unsigned char* a, const unsigned char* b, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += (uint32_t)a[i] * b[i];
+    return sum;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// n je djeljivo sa 32
+__attribute__((target("avx2")))
+uint32_t sad_u8_avx2(const unsigned char* a, const unsigned char* b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(va, vb));
+    }
+    __m128i t = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return (uint32_t)(_mm_cvtsi128_si64(t) + _mm_extract_epi64(t, 1));
+}
+
+// n je djeljivo sa 32; 32-bitni akumulatori ne mogu preći 2^31 za n < 2^15 * 8
+__attribute__((target("avx2")))
+uint64_t dot_u8_avx2(const unsigned char* a, const unsigned char* b, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_unpacklo_epi8(va, zero), _mm256_unpacklo_epi8(vb, zero)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_unpackhi_epi8(va, zero), _mm256_unpackhi_epi8(vb, zero)));
+    }
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256((__m256i*)lanes, acc);
+    uint64_t sum = 0;
+    for (uint32_t v : lanes) sum += v;
+    return sum;
+}
+#else
+uint32_t sad_u8_avx2(const unsigned char* a, const unsigned char* b, size_t n) { return sad_u8_scalar(a, b, n); }
+uint64_t dot_u8_avx2(const unsigned char* a, const unsigned char* b, size_t n) { return dot_u8_scalar(a, b, n); }
+#endif
+
+// Sivi isječak simbola: bbox najveće komponente binarne slike, invertovani sivi pikseli,
+// bilinearno na veličinu šablona i razvučen kontrast; prazan ako nema simbola
+std::vector<unsigned char> gray_symbol_crop(const std::vector<unsigned char>& binaryImg,
+                                            const std::vector<unsigned char>& grayImg, int width, int height,
+                                            const GrayTemplates& bank, const char* debugName) {
+    std::vector<unsigned char> inverted(binaryImg.size());
+    for (size_t i = 0; i < binaryImg.size(); ++i) inverted[i] = 255 - binaryImg[i];
+    int minX, minY, cropW, cropH;
+    if (grayImg.size() != binaryImg.size() ||
+        !largest_component_bbox(inverted, width, height, minX, minY, cropW, cropH)) {
+        LOG_ERROR("Nema kontura za obradu!");
+        return {};
+    }
+    std::vector<unsigned char> cropped(cropW * cropH);
+    for (int y = 0; y < cropH; y++)
+        for (int x = 0; x < cropW; x++) cropped[y * cropW + x] = 255 - grayImg[(y + minY) * width + x + minX];
+    if (debug_enabled()) debug_image(debugName, cropW, cropH, 1, cropped);
+
+    std::vector<unsigned char> resized = bilinear_resize(cropped, cropW, cropH, bank.width, bank.height);
+    stretch_contrast(resized.data(), resized.size());
+    resized.resize(bank.stride, 0);
+    return resized;
+}
+
+// Najbolji sivi šablon: najmanji SAD, odnosno najveća korelacija (rezultat 1 - ncc)
+int gray_matcher(const GrayTemplates& bank, const std::vector<unsigned char>& binaryImg,
+                 const std::vector<unsigned char>& grayImg, int width, int height, GrayMetric metric,
+                 unsigned candidates, const char* debugName, float* margin) {
+    std::vector<unsigned char> crop = gray_symbol_crop(binaryImg, grayImg, width, height, bank, debugName);
+    if (crop.empty()) return -1;
+
+    const bool avx2 = cpu_has_avx2();
+    const size_t n = (size_t)bank.width * bank.height;
+    double cropSum = 0, cropNorm = 0;
+    if (metric == GrayMetric::Ncc) {
+        double sumSq = avx2 ? dot_u8_avx2(crop.data(), crop.data(), bank.stride)
+                            : dot_u8_scalar(crop.data(), crop.data(), bank.stride);
+        for (size_t i = 0; i < n; ++i) cropSum += crop[i];
+        cropNorm = std::sqrt(std::max(0.0, sumSq - cropSum * cropSum / n));
+    }
+
+    int best = -1;
+    float minScore = 1e30f, secondScore = 1e30f;
+    for (size_t j = 0; j < bank.labels.size(); ++j) {
+        if (!(candidates & (1u << bank.labels[j]))) continue;
+        const unsigned char* tpl = &bank.pixels[j * bank.stride];
+        float score;
+        if (metric == GrayMetric::Sad) {
+            score = avx2 ? sad_u8_avx2(crop.data(), tpl, bank.stride) : sad_u8_scalar(crop.data(), tpl, bank.stride);
+        } else {
+            double dot = avx2 ? dot_u8_avx2(crop.data(), tpl, bank.stride) : dot_u8_scalar(crop.data(), tpl, bank.stride);
+            double denom = cropNorm * bank.norm[j];
+            double ncc = denom > 0 ? (dot - cropSum * bank.sum[j] / n) / denom : 0.0;
+            score = (float)(1.0 - ncc);
+        }
+        LOG_DEBUG(" -> %d has gray score: %g", bank.labels[j], score);
+        if (score < minScore) {
+            secondScore = minScore;
+            minScore = score;
+            best = bank.labels[j];
+        } else if (score < secondScore) {
+            secondScore = score;
+        }
+    }
+    if (margin) *margin = match_margin(minScore, secondScore);
+    return best;
+}
+
+int rankMatcherGray(const std::vector<unsigned char>& binaryRank, const std::vector<unsigned char>& grayRank,
+                    int width, int height, GrayMetric metric, float* margin = nullptr) {
+    int best = gray_matcher(gray_rank_templates(), binaryRank, grayRank, width, height, metric, ~0u,
+                            "_debug_gray_rank.png", margin);
+    LOG_DEBUG("Best match rank: %d", best);
+    return best;
+}
+
+int matchSuitGray(const std::vector<unsigned char>& binarySuit, const std::vector<unsigned char>& graySuit,
+                  int width, int height, GrayMetric metric, unsigned candidates = 0xF, float* margin = nullptr) {
+    int best = gray_matcher(gray_suit_templates(), binarySuit, graySuit, width, height, metric, candidates,
+                            "_debug_gray_suit.png", margin);
+    LOG_DEBUG("Best match suit: %d", best);
+    return best;
+}
+
+
+// ---------------------------------------------------------------------------
+// FFT korelacija (--matcher=fft): svi šabloni ranka i suita, u nekoliko
+// veličina, koreliraju se sa cijelim uglom u frekvencijskom domenu, bez
+// dijeljenja ugla na 60% i bez traženja najveće komponente. Spektri šablona
+// se računaju jednom. Normalizovana korelacija (šablon bez srednje vrijednosti,
+// energija prozora iz integralne slike) daje i položaj i identitet simbola.
+// ---------------------------------------------------------------------------
+
+const int FFT_W = 64, FFT_H = 128;   // >= veličine ugla (kružna korelacija je tačna za validne pozicije)
+// Veličine šablona (širina, visina) u pikselima ugla; perspektiva i warp mijenjaju
+// i odnos stranica simbola, pa se ne skalira samo visina
+const std::pair<int, int> FFT_RANK_SIZES[] = {{15, 28}, {19, 28}, {23, 28}, {15, 34}, {19, 34}, {23, 34}};
+const std::pair<int, int> FFT_SUIT_SIZES[] = {{16, 22}, {20, 25}};
+
+// Kompleksni niz kao odvojeni realni i imaginarni dio (SoA), da se leptiri vektorizuju
+struct ComplexPlane {
+    std::vector<float> re, im;
+    ComplexPlane() : re(FFT_W * FFT_H, 0.0f), im(FFT_W * FFT_H, 0.0f) {}
+};
+
+// Leptiri za cols susjednih kolona dva reda. DIT (inverzna): (a, b) <- (a + w b, a - w b);
+// DIF (direktna): (a, b) <- (a + b, (a - b) w)
+void fft_butterflies_scalar(float* ar, float* ai, float* br, float* bi, int cols, float wr, float wi, bool dif) {
+    for (int x = 0; x < cols; ++x) {
+        if (dif) {
+            float dr = ar[x] - br[x], di = ai[x] - bi[x];
+            ar[x] += br[x];
+            ai[x] += bi[x];
+            br[x] = dr * wr - di * wi;
+            bi[x] = dr * wi + di * wr;
+        } else {
+            float vr = br[x] * wr - bi[x] * wi, vi = br[x] * wi + bi[x] * wr;
+            br[x] = ar[x] - vr;
+            bi[x] = ai[x] - vi;
+            ar[x] += vr;
+            ai[x] += vi;
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// cols je djeljivo sa 8
+__attribute__((target("avx2")))
+void fft_butterflies_avx2(float* ar, float* ai, float* br, float* bi, int cols, float wr, float wi, bool dif) {
+    const __m256 vwr = _mm256_set1_ps(wr), vwi = _mm256_set1_ps(wi);
+    for (int x = 0; x < cols; x += 8) {
+        __m256 a = _mm256_loadu_ps(ar + x), c = _mm256_loadu_ps(ai + x);
+        __m256 r = _mm256_loadu_ps(br + x), i = _mm256_loadu_ps(bi + x);
+        if (dif) {
+            __m256 dr = _mm256_sub_ps(a, r), di = _mm256_sub_ps(c, i);
+            _mm256_storeu_ps(ar + x, _mm256_add_ps(a, r));
+            _mm256_storeu_ps(ai + x, _mm256_add_ps(c, i));
+            _mm256_storeu_ps(br + x, _mm256_sub_ps(_mm256_mul_ps(dr, vwr), _mm256_mul_ps(di, vwi)));
+            _mm256_storeu_ps(bi + x, _mm256_add_ps(_mm256_mul_ps(dr, vwi), _mm256_mul_ps(di, vwr)));
+        } else {
+            __m256 vr = _mm256_sub_ps(_mm256_mul_ps(r, vwr), _mm256_mul_ps(i, vwi));
+            __m256 vi = _mm256_add_ps(_mm256_mul_ps(r, vwi), _mm256_mul_ps(i, vwr));
+            _mm256_storeu_ps(br + x, _mm256_sub_ps(a, vr));
+            _mm256_storeu_ps(bi + x, _mm256_sub_ps(c, vi));
+            _mm256_storeu_ps(ar + x, _mm256_add_ps(a, vr));
+            _mm256_storeu_ps(ai + x, _mm256_add_ps(c, vi));
+        }
+    }
+}
+#else
+void fft_butterflies_avx2(float* ar, float* ai, float* br, float* bi, int cols, float wr, float wi, bool dif) {
+    fft_butterflies_scalar(ar, ai, br, bi, cols, wr, wi, dif);
+}
+#endif
+
+// p = x * a + i * (x * b): spektri korelacije dva šablona u jednom kompleksnom nizu
+// (b može biti nullptr)
+void fft_pair_product_scalar(const float* xr, const float* xi, const float* ar, const float* ai, const float* br,
+                             const float* bi, float* pr, float* pi, int n) {
+    for (int i = 0; i < n; ++i) {
+        pr[i] = xr[i] * ar[i] - xi[i] * ai[i];
+        pi[i] = xr[i] * ai[i] + xi[i] * ar[i];
+        if (br) {
+            pr[i] -= xr[i] * bi[i] + xi[i] * br[i];
+            pi[i] += xr[i] * br[i] - xi[i] * bi[i];
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// n je djeljivo sa 8
+__attribute__((target("avx2")))
+void fft_pair_product_avx2(const float* xr, const float* xi, const float* ar, const float* ai, const float* br,
+                           const float* bi, float* pr, float* pi, int n) {
+    for (int i = 0; i < n; i += 8) {
+        __m256 r = _mm256_loadu_ps(xr + i), m = _mm256_loadu_ps(xi + i);
+        __m256 a = _mm256_loadu_ps(ar + i), c = _mm256_loadu_ps(ai + i);
+        __m256 re = _mm256_sub_ps(_mm256_mul_ps(r, a), _mm256_mul_ps(m, c));
+        __m256 im = _mm256_add_ps(_mm256_mul_ps(r, c), _mm256_mul_ps(m, a));
+        if (br) {
+            __m256 b = _mm256_loadu_ps(br + i), d = _mm256_loadu_ps(bi + i);
+            re = _mm256_sub_ps(re, _mm256_add_ps(_mm256_mul_ps(r, d), _mm256_mul_ps(m, b)));
+            im = _mm256_add_ps(im, _mm256_sub_ps(_mm256_mul_ps(r, b), _mm256_mul_ps(m, d)));
+        }
+        _mm256_storeu_ps(pr + i, re);
+        _mm256_storeu_ps(pi + i, im);
+    }
+}
+#else
+void fft_pair_product_avx2(const float* xr, const float* xi, const float* ar, const float* ai, const float* br,
+                           const float* bi, float* pr, float* pi, int n) {
+    fft_pair_product_scalar(xr, xi, ar, ai, br, bi, pr, pi, n);
+}
+#endif
+
+// Radix-2 FFT dužine n nad kolonama matrice n x stride odjednom (unutrašnja petlja
+// ide preko susjednih kolona). Direktna je DIF i daje spektar u bit-obrnutom
+// redoslijedu, inverzna je DIT i očekuje ga, pa permutacija nikad ne treba:
+// množenje spektara po elementima ne zavisi od redoslijeda.
+struct FftColumns {
+    int n = 0;
+    std::vector<float> cosTable, sinTable;   // e^{-2 pi i k / n} = cos - i sin, k < n / 2
+
+    explicit FftColumns(int size) : n(size), cosTable(size / 2), sinTable(size / 2) {
+        for (int k = 0; k < n / 2; ++k) {
+            cosTable[k] = (float)std::cos(2.0 * M_PI * k / n);
+            sinTable[k] = (float)std::sin(2.0 * M_PI * k / n);
+        }
+    }
+
+    // Transformišu se samo prve cols kolone (ostale su nule ili se ne koriste);
+    // stride je dužina reda. Inverzna je bez skaliranja sa 1/n.
+    void run(float* re, float* im, int stride, int cols, bool inverse) const {
+        const bool avx2 = cpu_has_avx2() && cols % 8 == 0;
+        const float sign = inverse ? 1.0f : -1.0f;
+        for (int len = inverse ? 2 : n; inverse ? len <= n : len >= 2; len = inverse ? len << 1 : len >> 1) {
+            int step = n / len;
+            for (int i = 0; i < n; i += len)
+                for (int k = 0; k < len / 2; ++k) {
+                    const float wr = cosTable[k * step], wi = sign * sinTable[k * step];
+                    float* a = re + (i + k) * stride;
+                    float* b = re + (i + k + len / 2) * stride;
+                    float* c = im + (i + k) * stride;
+                    float* d = im + (i + k + len / 2) * stride;
+                    if (avx2)
+                        fft_butterflies_avx2(a, c, b, d, cols, wr, wi, !inverse);
+                    else
+                        fft_butterflies_scalar(a, c, b, d, cols, wr, wi, !inverse);
+                }
+        }
+    }
+};
+
+// Transponuje prvih rows x cols (ulaz ima red dužine inStride, izlaz outStride)
+void transpose_plane(const std::vector<float>& in, std::vector<float>& out, int rows, int cols, int inStride,
+                     int outStride) {
+    for (int y = 0; y < rows; ++y)
+        for (int x = 0; x < cols; ++x) out[x * outStride + y] = in[y * inStride + x];
+}
+
+// Prostorni raspored je [y][x] (FFT_H x FFT_W), spektralni [kx][ky] (FFT_W x FFT_H,
+// oba indeksa bit-obrnuta): transformacija po y, transponovanje, pa po x.
+// width je broj kolona koje mogu biti različite od nule.
+void fft2d_forward(ComplexPlane& a, int width = FFT_W) {
+    static const FftColumns alongY(FFT_H), alongX(FFT_W);
+    static thread_local std::vector<float> tmp(FFT_W * FFT_H);
+    const int cols = std::min(FFT_W, (width + 7) & ~7);
+    alongY.run(a.re.data(), a.im.data(), FFT_W, cols, false);
+    // Kolone x >= cols su i dalje nule
+    std::fill(tmp.begin(), tmp.end(), 0.0f);
+    transpose_plane(a.re, tmp, FFT_H, cols, FFT_W, FFT_H);
+    a.re.swap(tmp);
+    std::fill(tmp.begin(), tmp.end(), 0.0f);
+    transpose_plane(a.im, tmp, FFT_H, cols, FFT_W, FFT_H);
+    a.im.swap(tmp);
+    alongX.run(a.re.data(), a.im.data(), FFT_H, FFT_H, false);
+}
+
+// Obrnuto od fft2d_forward; rezultat je u [y][x] rasporedu, bez skaliranja,
+// i tačan samo u prvih width kolona
+void fft2d_inverse(ComplexPlane& a, int width = FFT_W) {
+    static const FftColumns alongY(FFT_H), alongX(FFT_W);
+    static thread_local std::vector<float> tmp(FFT_W * FFT_H);
+    const int cols = std::min(FFT_W, (width + 7) & ~7);
+    alongX.run(a.re.data(), a.im.data(), FFT_H, FFT_H, true);
+    transpose_plane(a.re, tmp, cols, FFT_H, FFT_H, FFT_W);
+    a.re.swap(tmp);
+    transpose_plane(a.im, tmp, cols, FFT_H, FFT_H, FFT_W);
+    a.im.swap(tmp);
+    alongY.run(a.re.data(), a.im.data(), FFT_W, cols, true);
+}
+
+struct FftTemplate {
+    int label;
+    bool isRank;
+    int width, height;
+    ComplexPlane spectrum;            // konjugovani spektar šablona sa srednjom vrijednošću 0 i normom 1
+};
+
+// Šablon (simbol svijetao na tamnom, kao invertovani ugao) umanjen na zadatu veličinu
+bool add_fft_template(const std::vector<unsigned char>& gray, int w, int h, int label, bool isRank,
+                      std::pair<int, int> size, std::vector<FftTemplate>& out) {
+    FftTemplate t;
+    t.label = label;
+    t.isRank = isRank;
+    t.width = size.first;
+    t.height = size.second;
+
+    // Usrednjavanje po površini: bilinearno uzorkovanje 4x manje slike gubi tanke linije
+    std::vector<double> small(t.width * t.height, 0.0);
+    for (int y = 0; y < t.height; ++y)
+        for (int x = 0; x < t.width; ++x) {
+            int x0 = x * w / t.width, x1 = std::max(x0 + 1, (x + 1) * w / t.width);
+            int y0 = y * h / t.height, y1 = std::max(y0 + 1, (y + 1) * h / t.height);
+            double acc = 0;
+            for (int sy = y0; sy < y1; ++sy)
+                for (int sx = x0; sx < x1; ++sx) acc += gray[sy * w + sx];
+            small[y * t.width + x] = acc / ((x1 - x0) * (y1 - y0));
+        }
+
+    double mean = 0, norm = 0;
+    for (double v : small) mean += v;
+    mean /= small.size();
+    for (double v : small) norm += (v - mean) * (v - mean);
+    norm = std::sqrt(norm);
+    if (norm == 0) return false;
+
+    for (int y = 0; y < t.height; ++y)
+        for (int x = 0; x < t.width; ++x) t.spectrum.re[y * FFT_W + x] = (float)((small[y * t.width + x] - mean) / norm);
+    fft2d_forward(t.spectrum, t.width);
+    for (float& v : t.spectrum.im) v = -v;
+    out.push_back(std::move(t));
+    return true;
+}
+
+const std::vector<FftTemplate>& fft_templates() {
+    static const std::vector<FftTemplate> bank = [] {
+        std::vector<FftTemplate> all;
+        const TemplateSet ranks = load_template_set(RANK_TEMPLATES), suits = load_template_set(SUIT_TEMPLATES);
+        for (size_t i = 0; i < ranks.gray.size(); ++i)
+            for (auto size : FFT_RANK_SIZES)
+                add_fft_template(ranks.gray[i], ranks.width, ranks.height, ranks.labels[i], true, size, all);
+        for (size_t i = 0; i < suits.gray.size(); ++i)
+            for (auto size : FFT_SUIT_SIZES)
+                add_fft_template(suits.gray[i], suits.width, suits.height, suits.labels[i], false, size, all);
+        return all;
+    }();
+    return bank;
+}
+
+// Prepoznaje rank i suit iz RGB ugla; rank je najbolji NCC među šablonima ranka,
+// suit najbolji među kandidatima čiji je prozor ispod sredine pronađenog ranka
+void fftClassify(const std::vector<unsigned char>& corner, int width, int height, int& rank, int& suit,
+                 unsigned candidates = 0xF, float* rankMargin = nullptr, float* suitMargin = nullptr) {
+    rank = suit = -1;
+    if (width > FFT_W || height > FFT_H) {
+        LOG_ERROR("Ugao %dx%d je veci od FFT prozora %dx%d", width, height, FFT_W, FFT_H);
+        return;
+    }
+    const auto& templates = fft_templates();
+
+    // Invertovani sivi ugao (simbol svijetao) i integralne slike za energiju prozora
+    ComplexPlane image;
+    const int iw = width + 1;
+    std::vector<double> sum(iw * (height + 1), 0), sumSq(iw * (height + 1), 0);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* p = &corner[(y * width + x) * 3];
+            float v = 255.0f - (0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2]);
+            image.re[y * FFT_W + x] = v;
+            int i = (y + 1) * iw + x + 1;
+            sum[i] = v + sum[i - 1] + sum[i - iw] - sum[i - iw - 1];
+            sumSq[i] = (double)v * v + sumSq[i - 1] + sumSq[i - iw] - sumSq[i - iw - 1];
+        }
+    fft2d_forward(image, width);
+
+    // 1 / (n * std) prozora za svaku veličinu šablona (veličine se ponavljaju među labelama);
+    // 0 za gotovo ravne prozore (pozadina)
+    std::vector<std::pair<int, int>> sizes;
+    std::vector<std::vector<float>> invNorm;
+    std::vector<int> sizeOf(templates.size());
+    for (size_t t = 0; t < templates.size(); ++t) {
+        std::pair<int, int> size(templates[t].width, templates[t].height);
+        auto it = std::find(sizes.begin(), sizes.end(), size);
+        sizeOf[t] = (int)(it - sizes.begin());
+        if (it != sizes.end()) continue;
+        sizes.push_back(size);
+        std::vector<float> inv(width * height, 0.0f);
+        const int tw = size.first, th = size.second;
+        const double n = (double)tw * th;
+        for (int y = 0; y + th <= height; ++y)
+            for (int x = 0; x + tw <= width; ++x) {
+                int i0 = y * iw + x, i1 = (y + th) * iw + x;
+                double s = sum[i1 + tw] - sum[i1] - sum[i0 + tw] + sum[i0];
+                double s2 = sumSq[i1 + tw] - sumSq[i1] - sumSq[i0 + tw] + sumSq[i0];
+                double var = s2 - s * s / n;
+                if (var >= n) inv[y * width + x] = (float)(1.0 / (FFT_W * FFT_H * std::sqrt(var)));
+            }
+        invNorm.push_back(std::move(inv));
+    }
+
+    // Najbolji NCC svakog šablona po redu gornje ivice prozora
+    std::vector<std::vector<float>> rowScore(templates.size(), std::vector<float>(height, -1.0f));
+
+    // Dva šablona po inverznoj transformaciji: korelacije su realne,
+    // pa jedna ide u realni, a druga u imaginarni dio
+    ComplexPlane product;
+    for (size_t j = 0; j < templates.size(); j += 2) {
+        const ComplexPlane& a = templates[j].spectrum;
+        const ComplexPlane* b = j + 1 < templates.size() ? &templates[j + 1].spectrum : nullptr;
+        (cpu_has_avx2() ? fft_pair_product_avx2 : fft_pair_product_scalar)(
+            image.re.data(), image.im.data(), a.re.data(), a.im.data(), b ? b->re.data() : nullptr,
+            b ? b->im.data() : nullptr, product.re.data(), product.im.data(), FFT_W * FFT_H);
+        fft2d_inverse(product, width);
+
+        for (size_t t = j; t < std::min(j + 2, templates.size()); ++t) {
+            const FftTemplate& tpl = templates[t];
+            const float* corr = t == j ? product.re.data() : product.im.data();
+            const float* inv = invNorm[sizeOf[t]].data();
+            for (int y = 0; y + tpl.height <= height; ++y) {
+                float best = rowScore[t][y];
+                for (int x = 0; x + tpl.width <= width; ++x)
+                    best = std::max(best, corr[y * FFT_W + x] * inv[y * width + x]);
+                rowScore[t][y] = best;
+            }
+        }
+    }
+
+    // Rank: najbolji šablon bilo koje veličine
+    float bestRank[14], bestSuit[4];
+    std::fill(bestRank, bestRank + 14, -1.0f);
+    std::fill(bestSuit, bestSuit + 4, -1.0f);
+    int rankY = 0, rankH = 0;
+    float top = -1.0f;
+    for (size_t t = 0; t < templates.size(); ++t) {
+        if (!templates[t].isRank) continue;
+        for (int y = 0; y < height; ++y) {
+            float v = rowScore[t][y];
+            bestRank[templates[t].label] = std::max(bestRank[templates[t].label], v);
+            if (v > top) {
+                top = v;
+                rank = templates[t].label;
+                rankY = y;
+                rankH = templates[t].height;
+            }
+        }
+    }
+
+    // Suit: samo ispod sredine ranka
+    int minSuitY = rank >= 0 ? rankY + rankH / 2 : 0;
+    for (size_t t = 0; t < templates.size(); ++t) {
+        if (templates[t].isRank || !(candidates & (1u << templates[t].label))) continue;
+        for (int y = minSuitY; y < height; ++y)
+            bestSuit[templates[t].label] = std::max(bestSuit[templates[t].label], rowScore[t][y]);
+    }
+    float topSuit = -1.0f;
+    for (int s = 0; s < 4; ++s)
+        if ((candidates & (1u << s)) && bestSuit[s] > topSuit) {
+            topSuit = bestSuit[s];
+            suit = s;
+        }
+    if (topSuit <= 0) suit = -1;
+    if (top <= 0) rank = -1;
+
+    // Margine na 1 - ncc (manje = bolje), kao kod ostalih matchera
+    auto margin = [](const float* best, int n, int winner) {
+        float second = -1.0f;
+        for (int i = 0; i < n; ++i)
+            if (i != winner) second = std::max(second, best[i]);
+        return match_margin(1.0f - best[winner], 1.0f - second);
+    };
+    if (rankMargin) *rankMargin = rank >= 0 ? margin(bestRank, 14, rank) : 0.0f;
+    if (suitMargin) *suitMargin = suit >= 0 ? margin(bestSuit, 4, suit) : 0.0f;
+    LOG_DEBUG("FFT rank %d (ncc %.3f, y %d), suit %d (ncc %.3f)", rank, top, rankY, suit, topSuit);
+}
+
+
+// ---------------------------------------------------------------------------
+// Chamfer matcher (--matcher=chamfer): za svaki šablon se jednom računa mapa
+// udaljenosti do ivice simbola (dva prolaza, maska 3-4). Isječak daje listu
+// svojih ivičnih piksela i sopstvenu mapu udaljenosti. Rezultat je srednja
+// udaljenost ivica isječka u šablonu i ivica šablona u isječku, pa razlike u
+// debljini poteza i pomaci od piksela malo koštaju.
+// ---------------------------------------------------------------------------
+
+const uint16_t CHAMFER_CAP = 30;      // 10 piksela; dalje ivice ne kvare rezultat više od toga
+
+struct ChamferTemplates {
+    int width = 0, height = 0;
+    std::vector<int> labels;
+    std::vector<std::vector<uint16_t>> dist;      // mapa udaljenosti po šablonu (x3)
+    std::vector<std::vector<uint32_t>> edges;     // indeksi ivičnih piksela po šablonu
+};
+
+// Ivični pikseli binarne slike (simbol = 255): simbol sa bar jednim susjedom pozadine
+std::vector<uint32_t> edge_pixels(const unsigned char* img, int width, int height) {
+    std::vector<uint32_t> edges;
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x) {
+            int i = y * width + x;
+            if (img[i] != 255) continue;
+            if (x == 0 || y == 0 || x == width - 1 || y == height - 1 || img[i - 1] != 255 ||
+                img[i + 1] != 255 || img[i - width] != 255 || img[i + width] != 255)
+                edges.push_back(i);
+        }
+    return edges;
+}
+
+// Chamfer 3-4 udaljenost do najbliže ivice, u dva prolaza (naprijed i nazad);
+// okvir od jednog piksela oko slike uklanja provjere granica u petljama
+std::vector<uint16_t> distance_transform(const std::vector<uint32_t>& edges, int width, int height) {
+    const uint16_t far = 0xFFFF / 2;
+    const int pw = width + 2;
+    std::vector<uint16_t> pad(pw * (height + 2), far);
+    for (uint32_t i : edges) pad[(i / width + 1) * pw + i % width + 1] = 0;
+    for (int y = 1; y <= height; ++y) {
+        uint16_t* r = &pad[y * pw];
+        const uint16_t* up = r - pw;
+        for (int x = 1; x <= width; ++x) {
+            int v = r[x];
+            v = std::min(v, r[x - 1] + 3);
+            v = std::min(v, up[x] + 3);
+            v = std::min(v, up[x - 1] + 4);
+            v = std::min(v, up[x + 1] + 4);
+            r[x] = (uint16_t)v;
+        }
+    }
+    for (int y = height; y >= 1; --y) {
+        uint16_t* r = &pad[y * pw];
+        const uint16_t* down = r + pw;
+        for (int x = width; x >= 1; --x) {
+            int v = r[x];
+            v = std::min(v, r[x + 1] + 3);
+            v = std::min(v, down[x] + 3);
+            v = std::min(v, down[x + 1] + 4);
+            v = std::min(v, down[x - 1] + 4);
+            r[x] = (uint16_t)v;
+        }
+    }
+    std::vector<uint16_t> d(width * height);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x) d[y * width + x] = std::min(pad[(y + 1) * pw + x + 1], CHAMFER_CAP);
+    return d;
+}
+
+ChamferTemplates load_chamfer_templates(const std::vector<std::pair<std::string, int>>& templates) {
+    const TemplateSet set = load_template_set(templates);
+    ChamferTemplates bank;
+    const int w = set.width, h = set.height;
+    bank.width = w;
+    bank.height = h;
+    bank.labels = set.labels;
+    for (const auto& gray : set.gray) {
+        std::vector<unsigned char> bin = binarize(gray.data(), w, h, 1);
+        bank.edges.push_back(edge_pixels(bin.data(), w, h));
+        bank.dist.push_back(distance_transform(bank.edges.back(), w, h));
+    }
+    return bank;
+}
+
+const ChamferTemplates& chamfer_rank_templates() {
+    static const ChamferTemplates bank = load_chamfer_templates(RANK_TEMPLATES);
+    return bank;
+}
+
+const ChamferTemplates& chamfer_suit_templates() {
+    static const ChamferTemplates bank = load_chamfer_templates(SUIT_TEMPLATES);
+    return bank;
+}
+
+// Najbolji šablon po simetričnoj chamfer udaljenosti; -1 ako nema simbola
+int chamfer_matcher(const ChamferTemplates& bank, const std::vector<unsigned char>& binaryImg, int width,
+                    int height, unsigned candidates, const char* debugName, float* margin) {
+    std::vector<unsigned char> inverted(binaryImg.size());
+    for (size_t i = 0; i < binaryImg.size(); ++i) inverted[i] = 255 - binaryImg[i];
+    int cropW, cropH;
+    std::vector<unsigned char> cropped = crop_component_tight(inverted, width, height, cropW, cropH);
+    if (cropped.empty()) {
+        LOG_ERROR("Nema kontura za obradu!");
+        return -1;
+    }
+    if (debug_enabled()) debug_image(debugName, cropW, cropH, 1, cropped);
+
+    std::vector<unsigned char> resized(bank.width * bank.height);
+    for (int y = 0; y < bank.height; y++)
+        for (int x = 0; x < bank.width; x++)
+            resized[y * bank.width + x] = cropped[(y * cropH / bank.height) * cropW + x * cropW / bank.width];
+    std::vector<uint32_t> edges = edge_pixels(resized.data(), bank.width, bank.height);
+    if (edges.empty()) return -1;
+    std::vector<uint16_t> dist = distance_transform(edges, bank.width, bank.height);
+
+    int best = -1;
+    float minScore = 1e30f, secondScore = 1e30f;
+    for (size_t j = 0; j < bank.labels.size(); ++j) {
+        if (!(candidates & (1u << bank.labels[j])) || bank.edges[j].empty()) continue;
+        const uint16_t* tplDist = bank.dist[j].data();
+        uint32_t forward = 0, backward = 0;
+        for (uint32_t i : edges) forward += tplDist[i];
+        for (uint32_t i : bank.edges[j]) backward += dist[i];
+        float score = ((float)forward / edges.size() + (float)backward / bank.edges[j].size()) / 6.0f;
+        LOG_DEBUG(" -> %d has chamfer distance: %.3f", bank.labels[j], score);
+        if (score < minScore) {
+            secondScore = minScore;
+            minScore = score;
+            best = bank.labels[j];
+        } else if (score < secondScore) {
+            secondScore = score;
+        }
+    }
+    if (margin) *margin = match_margin(minScore, secondScore);
+    return best;
+}
+
+int rankMatcherChamfer(const std::vector<unsigned char>& rankImg, int width, int height, float* margin = nullptr) {
+    int best = chamfer_matcher(chamfer_rank_templates(), rankImg, width, height, ~0u, "_debug_cropped_rank.png",
+                               margin);
+    LOG_DEBUG("Best match rank: %d", best);
+    return best;
+}
+
+int matchSuitChamfer(const std::vector<unsigned char>& suitImg, int width, int height, unsigned candidates = 0xF,
+                     float* margin = nullptr) {
+    int best = chamfer_matcher(chamfer_suit_templates(), suitImg, width, height, candidates,
+                               "_debug_cropped_suit.png", margin);
+    LOG_DEBUG("Best match suit: %d", best);
+    return best;
+}
+
+
+// ---------------------------------------------------------------------------
+// Ulazni frejmovi: JPEG/PNG (stb_image), binarni PGM/PPM i sirovi YUV (NV12, I420)
+// ---------------------------------------------------------------------------
+
+enum class PixelFormat { RGB, Gray, NV12, I420 };
+
+// Pogled na piksele jednog frejma. planes[0] je RGB ili Y (luma) ravan; za NV12
+// planes[1] je UV (isprepletano), za I420 planes[1] je U i planes[2] V.
+// owner drži bafer živim (stbi bafer, učitani fajl...), a može biti i prazan
+// kad frejm pokazuje na tuđu memoriju.
+struct Frame {
+    PixelFormat format = PixelFormat::RGB;
+    int width = 0, height = 0;
+    const unsigned char* planes[3] = {nullptr, nullptr, nullptr};
+    int strides[3] = {0, 0, 0};
+    std::shared_ptr<const unsigned char> owner;
+};
+
+// Dimenzije sirovog YUV ulaza (u fajlu nema zaglavlja)
+struct RawFormat {
+    PixelFormat format = PixelFormat::RGB; // RGB = odredi po ekstenziji
+    int width = 0, height = 0;
+    int stride = 0;                        // bajtova po redu Y ravni; 0 = width
+};
+
+// BT.601 (ograničeni opseg, kao kod kamera) za jedan piksel
+inline void yuv_to_rgb(int Y, int U, int V, unsigned char* rgb) {
+    int c = Y - 16, d = U - 128, e = V - 128;
+    rgb[0] = (unsigned char)std::clamp((298 * c + 409 * e + 128) >> 8, 0, 255);
+    rgb[1] = (unsigned char)std::clamp((298 * c - 100 * d - 208 * e + 128) >> 8, 0, 255);
+    rgb[2] = (unsigned char)std::clamp((298 * c + 516 * d + 128) >> 8, 0, 255);
+}
+
+inline void frame_pixel_rgb(const Frame& f, int x, int y, unsigned char* rgb) {
+    const unsigned char* luma = f.planes[0] + (size_t)y * f.strides[0];
+    switch (f.format) {
+    case PixelFormat::RGB:
+        rgb[0] = luma[x * 3];
+        rgb[1] = luma[x * 3 + 1];
+        rgb[2] = luma[x * 3 + 2];
+        break;
+    case PixelFormat::Gray:
+        rgb[0] = rgb[1] = rgb[2] = luma[x];
+        break;
+    case PixelFormat::NV12: {
+        const unsigned char* uv = f.planes[1] + (size_t)(y / 2) * f.strides[1] + (x & ~1);
+        yuv_to_rgb(luma[x], uv[0], uv[1], rgb);
+        break;
+    }
+    case PixelFormat::I420:
+        yuv_to_rgb(luma[x], f.planes[1][(size_t)(y / 2) * f.strides[1] + x / 2],
+                   f.planes[2][(size_t)(y / 2) * f.strides[2] + x / 2], rgb);
+        break;
+    }
+}
+
+std::vector<unsigned char> warp_frame(const Frame& f, const std::array<Point2f, 4>& corners, int dstW, int dstH) {
+    if (f.format == PixelFormat::RGB && f.strides[0] == f.width * 3)
+        return warp_image(f.planes[0], f.width, f.height, corners, dstW, dstH);
+    return warp_sampled(f.width, f.height, corners, dstW, dstH,
+                        [&](int px, int py, unsigned char* rgb) { frame_pixel_rgb(f, px, py, rgb); });
+}
+
+bool read_file(const std::string& path, std::shared_ptr<const unsigned char>& data, size_t& size) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    size = (size_t)in.tellg();
+    std::shared_ptr<unsigned char> buf(new unsigned char[size ? size : 1], std::default_delete<unsigned char[]>());
+    in.seekg(0);
+    if (!in.read((char*)buf.get(), size)) return false;
+    data = buf;
+    return true;
+}
+
+// Binarni PGM (P5) i PPM (P6) sa maxval <= 255; pikseli ostaju u učitanom baferu
+bool parse_netpbm(const std::shared_ptr<const unsigned char>& data, size_t size, Frame& f) {
+    const unsigned char* p = data.get();
+    if (size < 2 || p[0] != 'P' || (p[1] != '5' && p[1] != '6')) return false;
+    bool color = p[1] == '6';
+    size_t pos = 2;
+    int fields[3];
+    for (int& v : fields) {
+        while (pos < size && (isspace(p[pos]) || p[pos] == '#')) {
+            if (p[pos] == '#')
+                while (pos < size && p[pos] != '\n') ++pos;
+            else
+                ++pos;
+        }
+        if (pos >= size || !isdigit(p[pos])) return false;
+        v = 0;
+        while (pos < size && isdigit(p[pos]) && v < 100000) v = v * 10 + (p[pos++] - '0');
+    }
+    ++pos; // jedan razmak prije piksela
+    int w = fields[0], h = fields[1], maxval = fields[2];
+    if (w <= 0 || h <= 0 || maxval <= 0 || maxval > 255) return false;
+    int stride = w * (color ? 3 : 1);
+    if (pos > size || size - pos < (size_t)stride * h) return false;
+
+    f.format = color ? PixelFormat::RGB : PixelFormat::Gray;
+    f.width = w;
+    f.height = h;
+    f.planes[0] = p + pos;
+    f.strides[0] = stride;
+    f.owner = data;
+    return true;
+}
+
+bool has_extension(const std::string& path, const char* ext) {
+    size_t n = strlen(ext);
+    if (path.size() < n) return false;
+    for (size_t i = 0; i < n; ++i)
+        if (tolower((unsigned char)path[path.size() - n + i]) != ext[i]) return false;
+    return true;
+}
+
+// Mapira cijeli fajl samo za čitanje; mapiranje živi dok postoji neki vlasnik bafera.
+// Fajl se čita redom (MADV_SEQUENTIAL); uz willNeed kernel odmah počinje readahead,
+// za fajlove koji će tek doći na red. Van Linuxa se fajl jednostavno učita.
+bool map_file(const std::string& path, std::shared_ptr<const unsigned char>& data, size_t& size,
+              bool willNeed = false) {
+#ifdef __linux__
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    size = (size_t)st.st_size;
+    void* mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) return false;
+    madvise(mem, size, MADV_SEQUENTIAL);
+    if (willNeed) madvise(mem, size, MADV_WILLNEED);
+    data.reset(static_cast<const unsigned char*>(mem), [size](const unsigned char* p) { munmap((void*)p, size); });
+    return true;
+#else
+    (void)willNeed;
+    return read_file(path, data, size);
+#endif
+}
+
+// Sirovi YUV se prepoznaje po raw.format ili po ekstenziji (.nv12, .i420/.yuv)
+PixelFormat raw_yuv_format(const std::string& path, const RawFormat& raw) {
+    if (raw.format != PixelFormat::RGB) return raw.format;
+    if (has_extension(path, ".nv12")) return PixelFormat::NV12;
+    if (has_extension(path, ".i420") || has_extension(path, ".yuv")) return PixelFormat::I420;
+    return PixelFormat::RGB;
+}
+
+// Frejm iz sadržaja fajla u memoriji: YUV i PGM/PPM pikseli ostaju u baferu,
+// a JPEG/PNG se dekodiraju sa stbi_load_from_memory
+bool decode_frame(const std::string& path, const std::shared_ptr<const unsigned char>& data, size_t size,
+                  const RawFormat& raw, Frame& f) {
+    PixelFormat yuv = raw_yuv_format(path, raw);
+    if (yuv == PixelFormat::NV12 || yuv == PixelFormat::I420) {
+        int w = raw.width, h = raw.height, stride = raw.stride ? raw.stride : raw.width;
+        if (w <= 0 || h <= 0 || stride < w || (w | h) & 1) {
+            LOG_ERROR("YUV ulaz zahtijeva parne --width/--height i --stride >= width: %s", path.c_str());
+            return false;
+        }
+        size_t lumaSize = (size_t)stride * h;
+        int chromaStride = (yuv == PixelFormat::NV12) ? stride : stride / 2;
+        size_t chromaSize = (size_t)chromaStride * (h / 2);
+        size_t needed = lumaSize + chromaSize * (yuv == PixelFormat::NV12 ? 1 : 2);
+        if (size < needed) {
+            LOG_ERROR("YUV fajl je kraci od %zu bajtova: %s", needed, path.c_str());
+            return false;
+        }
+        f.format = yuv;
+        f.width = w;
+        f.height = h;
+        f.planes[0] = data.get();
+        f.strides[0] = stride;
+        f.planes[1] = data.get() + lumaSize;
+        f.strides[1] = chromaStride;
+        if (yuv == PixelFormat::I420) {
+            f.planes[2] = f.planes[1] + chromaSize;
+            f.strides[2] = chromaStride;
+        }
+        f.owner = data;
+        return true;
+    }
+
+    if (has_extension(path, ".pgm") || has_extension(path, ".ppm")) {
+        if (!parse_netpbm(data, size, f)) {
+            LOG_ERROR("Greska pri ucitavanju slike: %s", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    int width, height, channels;
+    unsigned char* image = stbi_load_from_memory(data.get(), (int)size, &width, &height, &channels, 3);
+    if (!image) {
+        LOG_ERROR("Greska pri ucitavanju slike: %s", path.c_str());
+        return false;
+    }
+    f.format = PixelFormat::RGB;
+    f.width = width;
+    f.height = height;
+    f.planes[0] = image;
+    f.strides[0] = width * 3;
+    f.owner.reset(image, stbi_image_free);
+    return true;
+}
+
+// Učitava frejm: .pgm/.ppm direktno, .nv12/.i420 (ili raw.format) kao sirovi YUV
+// sa zadatim dimenzijama, ostalo preko stb_image kao RGB
+bool load_frame(const std::string& path, const RawFormat& raw, Frame& f) {
+    std::shared_ptr<const unsigned char> data;
+    size_t size;
+    if (!map_file(path, data, size)) {
+        LOG_ERROR("Greska pri ucitavanju slike: %s", path.c_str());
+        return false;
+    }
+    return decode_frame(path, data, size, raw, f);
+}
+
+// Redom čita ulaze batch obrade; dok se jedan fajl dekodira, sljedećih
+// BATCH_READAHEAD je već mapirano sa MADV_WILLNEED pa ih kernel učitava unaprijed
+const size_t BATCH_READAHEAD = 4;
+
+class BatchReader {
+public:
+    explicit BatchReader(const std::vector<std::string>& paths) : paths(paths) {}
+
+    bool done() const { return next >= paths.size(); }
+    const std::string& path() const { return paths[next]; }
+
+    // Frejm za path() i prelazak na sljedeći ulaz
+    bool read(const RawFormat& raw, Frame& f) {
+        while (mapped.size() < BATCH_READAHEAD + 1 && next + mapped.size() < paths.size()) {
+            MappedInput in;
+            in.ok = map_file(paths[next + mapped.size()], in.data, in.size, true);
+            mapped.push_back(std::move(in));
+        }
+        MappedInput in = std::move(mapped.front());
+        mapped.pop_front();
+        const std::string& p = paths[next++];
+        if (!in.ok) {
+            LOG_ERROR("Greska pri ucitavanju slike: %s", p.c_str());
+            return false;
+        }
+        return decode_frame(p, in.data, in.size, raw, f);
+    }
+
+private:
+    struct MappedInput {
+        std::shared_ptr<const unsigned char> data;
+        size_t size = 0;
+        bool ok = false;
+    };
+
+    const std::vector<std::string>& paths;
+    std::deque<MappedInput> mapped;
+    size_t next = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Čitač sa prefetch-om za batch obradu (--reader=uring|thread): drži do
+// --io-depth čitanja fajlova u toku ispred dekodiranja, u bafere iz zajedničkog
+// pool-a. io_uring se koristi direktno preko sistemskih poziva (bez liburing),
+// sa registrovanim (fixed) baferima; kad io_uring nije dostupan, čita pozadinska nit.
+// ---------------------------------------------------------------------------
+
+enum class ReaderMode { Mmap, Uring, Thread };
+
+const size_t IO_BUFFER_MAX = 64u << 20; // veći fajlovi se čitaju preko map_file
+
+// Pool bafera jednake veličine; bafer se vraća kad nestane posljednji vlasnik
+class BufferPool {
+public:
+    BufferPool(size_t count, size_t bytes) : bytes(bytes) {
+        for (size_t i = 0; i < count; ++i) {
+            void* p = nullptr;
+            if (posix_memalign(&p, 4096, bytes) != 0) break;
+            buffers.push_back(static_cast<unsigned char*>(p));
+            freeList.push_back((int)i);
+        }
+    }
+    ~BufferPool() {
+        for (auto* b : buffers) free(b);
+    }
+
+    int acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeList.empty()) return -1;
+        int i = freeList.back();
+        freeList.pop_back();
+        return i;
+    }
+
+    void release(int i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeList.push_back(i);
+        }
+        released.notify_all();
+    }
+
+    // Vlasnik bafera za Frame/decode; bafer se vraća u pool kad ga svi puste
+    std::shared_ptr<const unsigned char> share(int i) {
+        return std::shared_ptr<const unsigned char>(buffers[i], [this, i](const unsigned char*) { release(i); });
+    }
+
+    unsigned char* data(int i) { return buffers[i]; }
+    size_t count() const { return buffers.size(); }
+
+    const size_t bytes;
+    std::condition_variable released;
+    std::mutex mutex;
+
+private:
+    std::vector<unsigned char*> buffers;
+    std::vector<int> freeList;
+};
+
+// Jedan fajl u prozoru čitanja
+struct PendingRead {
+    std::string path;
+    int fd = -1;
+    int buffer = -1;
+    size_t size = 0, done = 0;
+    bool ready = false, ok = false;
+};
+
+#ifdef __linux__
+// Minimalni io_uring: jedan SQ/CQ par mapiran iz kernela
+class IoUring {
+public:
+    bool init(unsigned entries) {
+        io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+        if (fd < 0) return false;
+
+        sqSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqSize = cqSize = std::max(sqSize, cqSize);
+        sqPtr = mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqPtr == MAP_FAILED) return false;
+        cqPtr = single ? sqPtr
+                       : mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqPtr == MAP_FAILED) return false;
+        sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(
+            mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            sqes = nullptr;
+            return false;
+        }
+
+        auto* sq = static_cast<unsigned char*>(sqPtr);
+        auto* cq = static_cast<unsigned char*>(cqPtr);
+        sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    ~IoUring() {
+        if (sqes) munmap(sqes, sqesSize);
+        if (cqPtr && cqPtr != MAP_FAILED && cqPtr != sqPtr) munmap(cqPtr, cqSize);
+        if (sqPtr && sqPtr != MAP_FAILED) munmap(sqPtr, sqSize);
+        if (fd >= 0) close(fd);
+    }
+
+    bool register_buffers(const std::vector<iovec>& iov) {
+        return syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iov.data(), (unsigned)iov.size()) == 0;
+    }
+
+    // READ_FIXED u registrovani bafer; user_data identifikuje zahtjev
+    void queue_read(int fileFd, int bufIndex, unsigned char* dst, unsigned len, uint64_t offset, uint64_t userData) {
+        unsigned tail = *sqTail;
+        unsigned idx = tail & sqMask;
+        io_uring_sqe* sqe = &sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->fd = fileFd;
+        sqe->addr = (uint64_t)(uintptr_t)dst;
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->buf_index = (uint16_t)bufIndex;
+        sqe->user_data = userData;
+        sqArray[idx] = idx;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++toSubmit;
+    }
+
+    // Predaje zahtjeve i čeka bar waitNr završenih
+    bool enter(unsigned waitNr) {
+        int r;
+        do {
+            r = (int)syscall(__NR_io_uring_enter, fd, toSubmit, waitNr, waitNr ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        } while (r < 0 && errno == EINTR);
+        if (r < 0) return false;
+        unsigned submitted = std::min<unsigned>(toSubmit, (unsigned)r);
+        toSubmit -= submitted;
+        inFlight += submitted;
+        return true;
+    }
+
+    bool pop(uint64_t& userData, int& res) {
+        unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) return false;
+        const io_uring_cqe& cqe = cqes[head & cqMask];
+        userData = cqe.user_data;
+        res = cqe.res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        --inFlight;
+        return true;
+    }
+
+    // Predati zahtjevi koji još nisu završeni (kernel još može da piše u njihove bafere)
+    unsigned in_flight() const { return inFlight; }
+
+private:
+    int fd = -1;
+    void* sqPtr = nullptr;
+    void* cqPtr = nullptr;
+    size_t sqSize = 0, cqSize = 0, sqesSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned *sqTail = nullptr, *sqArray = nullptr, *cqHead = nullptr, *cqTail = nullptr;
+    unsigned sqMask = 0, cqMask = 0, toSubmit = 0, inFlight = 0;
+};
+#endif
+
+// Redom isporučuje sadržaj fajlova, sa do depth čitanja u toku unaprijed.
+// Isti interfejs kao BatchReader (done/path/read).
+class PrefetchReader {
+public:
+    PrefetchReader(const std::vector<std::string>& paths, ReaderMode mode, int depth)
+        : paths(paths), depth(std::max(1, depth)), pool((size_t)std::max(1, depth) + 1, buffer_size(paths)) {
+#ifdef __linux__
+        if (mode == ReaderMode::Uring) {
+            std::vector<iovec> iov;
+            for (size_t i = 0; i < pool.count(); ++i) iov.push_back({pool.data((int)i), pool.bytes});
+            if (ring.init((unsigned)this->depth * 2) && ring.register_buffers(iov)) {
+                useUring = true;
+            } else {
+                LOG_WARN("[IO] io_uring nije dostupan, citanje iz pozadinske niti");
+            }
+        }
+#else
+        (void)mode;
+#endif
+        if (!useUring) worker = std::thread(&PrefetchReader::thread_loop, this, (size_t)0);
+    }
+
+    ~PrefetchReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        pool.released.notify_all();
+        // Frejmovi koji još drže bafer iz pool-a moraju biti uništeni prije čitača
+        if (worker.joinable()) worker.join();
+        for (auto& r : window)
+            if (r.fd >= 0) close(r.fd);
+    }
+
+    bool done() const { return next >= paths.size(); }
+    const std::string& path() const { return paths[next]; }
+    const char* backend() const { return useUring ? "io_uring" : "nit"; }
+
+    // Frejm za path() i prelazak na sljedeći ulaz
+    bool read(const RawFormat& raw, Frame& f) {
+        const std::string& p = paths[next];
+        auto start = std::chrono::steady_clock::now();
+        PendingRead r;
+        if (useUring) {
+#ifdef __linux__
+            bool submitted = uring_fill();
+            while (submitted && window.empty()) { // svi baferi su još kod prethodnih frejmova
+                std::unique_lock<std::mutex> poolLock(pool.mutex);
+                pool.released.wait_for(poolLock, std::chrono::milliseconds(10));
+                poolLock.unlock();
+                submitted = uring_fill();
+            }
+            while (submitted && !window.front().ready) submitted = ring.enter(1) && uring_reap();
+            if (!submitted) {
+                uring_abort();
+                return read(raw, f);
+            }
+            r = std::move(window.front());
+            window.pop_front();
+            ++next;
+#endif
+        } else {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return !window.empty() && window.front().ready; });
+            r = std::move(window.front());
+            window.pop_front();
+            ++next;
+            lock.unlock();
+            cv.notify_all();
+        }
+        ioWaitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (r.fd >= 0) close(r.fd);
+
+        std::shared_ptr<const unsigned char> data;
+        size_t size = r.size;
+        if (r.buffer >= 0) {
+            data = pool.share(r.buffer);
+        } else if (r.ok) {
+            r.ok = map_file(p, data, size); // prevelik za pool
+        }
+        if (!r.ok) {
+            LOG_ERROR("Greska pri ucitavanju slike: %s", p.c_str());
+            return false;
+        }
+        bytesRead += size;
+        return decode_frame(p, data, size, raw, f);
+    }
+
+    uint64_t ioWaitNs = 0, bytesRead = 0;
+
+private:
+    // Bafer dovoljan za najveći ulaz (do IO_BUFFER_MAX), zaokružen na stranicu
+    static size_t buffer_size(const std::vector<std::string>& paths) {
+        size_t maxSize = 4096;
+        struct stat st;
+        for (const auto& p : paths)
+            if (stat(p.c_str(), &st) == 0 && (size_t)st.st_size <= IO_BUFFER_MAX)
+                maxSize = std::max(maxSize, (size_t)st.st_size);
+        return (maxSize + 4095) & ~(size_t)4095;
+    }
+
+    // Otvara sljedeći fajl; false ako nije dobio bafer iz pool-a
+    bool open_next(PendingRead& r, size_t index) {
+        r.path = paths[index];
+        struct stat st;
+        r.fd = open(r.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (r.fd < 0 || fstat(r.fd, &st) != 0 || st.st_size <= 0) {
+            r.ready = true;
+            return true;
+        }
+        r.size = (size_t)st.st_size;
+        if (r.size > pool.bytes) { // čita se kasnije preko map_file
+            r.ok = r.ready = true;
+            return true;
+        }
+        r.buffer = pool.acquire();
+        if (r.buffer < 0) {
+            close(r.fd);
+            r.fd = -1;
+            return false;
+        }
+        return true;
+    }
+
+#ifdef __linux__
+    // false ako io_uring_enter nije uspio (zahtjevi su ostali nepredati)
+    bool uring_fill() {
+        while (window.size() < (size_t)depth && next + window.size() < paths.size()) {
+            PendingRead r;
+            if (!open_next(r, next + window.size())) break;
+            window.push_back(std::move(r));
+            uring_submit(window.back(), next + window.size() - 1);
+        }
+        return ring.enter(0);
+    }
+
+    void uring_submit(PendingRead& r, size_t index) {
+        if (r.ready) return;
+        size_t len = std::min<size_t>(r.size - r.done, 1u << 30);
+        ring.queue_read(r.fd, r.buffer, pool.data(r.buffer) + r.done, (unsigned)len, r.done, index);
+    }
+
+    bool uring_reap() {
+        uint64_t index;
+        int res;
+        while (ring.pop(index, res)) {
+            PendingRead& r = window[index - next];
+            if (res <= 0) {
+                r.ready = true;
+                pool.release(r.buffer);
+                r.buffer = -1;
+                continue;
+            }
+            r.done += res;
+            if (r.done < r.size) {
+                uring_submit(r, index); // kratko čitanje, nastavak od r.done
+            } else {
+                r.ok = r.ready = true;
+            }
+        }
+        return ring.enter(0);
+    }
+
+    // io_uring_enter ne radi: prvo se čeka da se završe već predata čitanja, jer kernel
+    // piše u bafere iz pool-a. Zadržavaju se fajlovi sa početka prozora koji su cijeli
+    // stigli, a od prvog nedovršenog (nepredat ili kratko čitanje) sve ponovo čita
+    // rezervna nit.
+    void uring_abort() {
+        LOG_WARN("[IO] io_uring_enter nije uspio, citanje se nastavlja iz pozadinske niti");
+        uint64_t index;
+        int res;
+        while (ring.in_flight() > 0) {
+            if (!ring.pop(index, res)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            if (res > 0) window[index - next].done += res;
+        }
+        size_t kept = 0;
+        for (; kept < window.size(); ++kept) {
+            PendingRead& w = window[kept];
+            if (w.ready) continue;
+            if (w.done != w.size) break;
+            w.ok = w.ready = true;
+        }
+        for (size_t i = kept; i < window.size(); ++i) {
+            if (window[i].fd >= 0) close(window[i].fd);
+            if (window[i].buffer >= 0) pool.release(window[i].buffer);
+        }
+        window.resize(kept);
+        useUring = false;
+        worker = std::thread(&PrefetchReader::thread_loop, this, next + kept);
+    }
+#endif
+
+    // Rezervni čitač: nit čita fajlove redom od first i puni prozor do depth
+    void thread_loop(size_t first) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (size_t index = first; index < paths.size(); ++index) {
+            cv.wait(lock, [&] { return stopping || index - next < (size_t)depth; });
+            if (stopping) return;
+            lock.unlock();
+            PendingRead r;
+            while (!open_next(r, index)) { // svi baferi su kod dekodera
+                std::unique_lock<std::mutex> poolLock(pool.mutex);
+                pool.released.wait_for(poolLock, std::chrono::milliseconds(10));
+                if (stopping) return;
+            }
+            if (!r.ready) {
+                while (r.done < r.size) {
+                    ssize_t n = pread(r.fd, pool.data(r.buffer) + r.done, r.size - r.done, r.done);
+                    if (n <= 0) break;
+                    r.done += n;
+                }
+                r.ok = r.done == r.size;
+                r.ready = true;
+                if (!r.ok) {
+                    pool.release(r.buffer);
+                    r.buffer = -1;
+                }
+            }
+            lock.lock();
+            window.push_back(std::move(r));
+            cv.notify_all();
+        }
+    }
+
+    const std::vector<std::string>& paths;
+    const int depth;
+    BufferPool pool;
+#ifdef __linux__
+    IoUring ring;
+#endif
+    bool useUring = false;
+    std::deque<PendingRead> window;
+    size_t next = 0;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> stopping{false};
+};
+
+
+// ---------------------------------------------------------------------------
+// Model pozadine (--background): kamera je fiksna iznad stola, pa se prazan sto
+// uči kao srednja luma blokova, a karta se traži samo u oblasti koja se promijenila
+// ---------------------------------------------------------------------------
+
+const int BG_BLOCK = 16;               // blok modela u pikselima frejma
+const int BG_SAMPLE_STEP = 4;          // luma bloka iz svakog 4. piksela po x i y
+const int BG_DIFF = 16;                // razlika srednje vrijednosti bloka koja znači promjenu
+const int BG_LEARN_SHIFT = 5;          // nepromijenjeni blokovi se uče brzinom 1/32 po frejmu
+const int BG_LEARN_CHANGED_SHIFT = 10; // promijenjeni 1/1024: karta na stolu ostaje promjena oko minut
+const int BG_MIN_BLOCKS = 6;           // manje oblasti su šum ili sjenka
+const int BG_MARGIN_BLOCKS = 2;        // oblast se širi da zaobljeni uglovi karte ne budu odsječeni
+const float BG_MAX_CHANGED = 0.5f;     // veća promjena je osvjetljenje ili pomjerena kamera
+const int BG_STALE_FRAMES = 30;        // blok promijenjen ovoliko frejmova bez karte ulazi u pozadinu
+const int BG_LEARN_FRAMES_DEFAULT = 10;
+
+enum class BackgroundState { Learning, Empty, Changed, Relearn };
+
+struct BackgroundRoi {
+    int x = 0, y = 0, width = 0, height = 0;
+};
+
+struct BackgroundModel {
+    int learnFrames = BG_LEARN_FRAMES_DEFAULT;
+    int width = 0, height = 0, blocksX = 0, blocksY = 0;
+    int seen = 0;                          // frejmova naučenih od (ponovnog) početka
+    std::vector<uint16_t> mean;            // Q8 srednja luma bloka praznog stola
+    std::vector<uint16_t> stale;           // uzastopni frejmovi promjene bloka bez pronađene karte
+    std::vector<unsigned char> luma, changed;  // radni baferi, po bloku
+    std::vector<int> component, stack;
+    int regionX0 = 0, regionY0 = 0, regionX1 = -1, regionY1 = -1;  // okvir posljednje oblasti, u blokovima
+};
+
+// Srednja luma blokova iz uzoraka, pa se čita 1/16 frejma; RGB luma je (r + 2g + b) / 4
+void frame_block_luma(const Frame& f, int blocksX, int blocksY, std::vector<unsigned char>& out) {
+    const int perAxis = BG_BLOCK / BG_SAMPLE_STEP, perBlock = perAxis * perAxis;
+    out.resize((size_t)blocksX * blocksY);
+    std::vector<uint32_t> sums(blocksX);
+    for (int by = 0; by < blocksY; ++by) {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (int y = by * BG_BLOCK + BG_SAMPLE_STEP / 2; y < (by + 1) * BG_BLOCK; y += BG_SAMPLE_STEP) {
+            const unsigned char* row = f.planes[0] + (size_t)y * f.strides[0];
+            if (f.format == PixelFormat::RGB) {
+                for (int x = BG_SAMPLE_STEP / 2; x < blocksX * BG_BLOCK; x += BG_SAMPLE_STEP) {
+                    const unsigned char* p = row + x * 3;
+                    sums[x / BG_BLOCK] += (p[0] + 2 * p[1] + p[2]) >> 2;
+                }
+            } else {
+                for (int x = BG_SAMPLE_STEP / 2; x < blocksX * BG_BLOCK; x += BG_SAMPLE_STEP)
+                    sums[x / BG_BLOCK] += row[x];
+            }
+        }
+        for (int bx = 0; bx < blocksX; ++bx)
+            out[(size_t)by * blocksX + bx] = (unsigned char)((sums[bx] + perBlock / 2) / perBlock);
+    }
+}
+
+// Najveća 8-povezana oblast promijenjenih blokova; vraća broj blokova i njen okvir u blokovima
+int largest_changed_region(BackgroundModel& bg, int& bx0, int& by0, int& bx1, int& by1) {
+    const int bw = bg.blocksX, bh = bg.blocksY;
+    bg.component.assign((size_t)bw * bh, 0);
+    std::vector<int>& stack = bg.stack;
+    int best = 0, label = 0;
+    for (int start = 0; start < bw * bh; ++start) {
+        if (!bg.changed[start] || bg.component[start]) continue;
+        int count = 0, x0 = bw, y0 = bh, x1 = -1, y1 = -1;
+        bg.component[start] = ++label;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int i = stack.back();
+            stack.pop_back();
+            int x = i % bw, y = i / bw;
+            ++count;
+            x0 = std::min(x0, x), x1 = std::max(x1, x);
+            y0 = std::min(y0, y), y1 = std::max(y1, y);
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int nx = x + dx, ny = y + dy;
+                    if (nx < 0 || ny < 0 || nx >= bw || ny >= bh) continue;
+                    int j = ny * bw + nx;
+                    if (bg.changed[j] && !bg.component[j]) {
+                        bg.component[j] = label;
+                        stack.push_back(j);
+                    }
+                }
+        }
+        if (count > best) {
+            best = count;
+            bx0 = x0, by0 = y0, bx1 = x1, by1 = y1;
+        }
+    }
+    return best;
+}
+
+// Poslije traženja karte u promijenjenoj oblasti: blokovi pronađene karte ostaju promjena,
+// a ostali promijenjeni blokovi stare. Blok koji BG_STALE_FRAMES frejmova zaredom nije
+// karta (npr. karta koja je bila na stolu dok se model učio, pa je sklonjena) ulazi u model.
+void background_age(BackgroundModel& bg, bool cardFound) {
+    size_t absorbed = 0;
+    for (int by = 0; by < bg.blocksY; ++by)
+        for (int bx = 0; bx < bg.blocksX; ++bx) {
+            size_t i = (size_t)by * bg.blocksX + bx;
+            if (!bg.changed[i]) continue;
+            bool inCard = cardFound && bx >= bg.regionX0 && bx <= bg.regionX1 && by >= bg.regionY0 &&
+                          by <= bg.regionY1;
+            if (inCard) {
+                bg.stale[i] = 0;
+            } else if (++bg.stale[i] >= BG_STALE_FRAMES) {
+                bg.mean[i] = (uint16_t)(bg.luma[i] << 8);
+                bg.stale[i] = 0;
+                ++absorbed;
+            }
+        }
+    if (absorbed) LOG_DEBUG("[BG] %zu blokova bez karte preslo u pozadinu", absorbed);
+}
+
+// Poredi frejm sa modelom i uči pozadinu. Changed daje roi najveće promijenjene oblasti;
+// Learning i Relearn znače da se karta traži u cijelom frejmu, a Empty da karte nema.
+BackgroundState background_update(BackgroundModel& bg, const Frame& frame, BackgroundRoi& roi) {
+    if (frame.width != bg.width || frame.height != bg.height) {
+        bg.width = frame.width;
+        bg.height = frame.height;
+        bg.blocksX = frame.width / BG_BLOCK;
+        bg.blocksY = frame.height / BG_BLOCK;
+        bg.mean.assign((size_t)bg.blocksX * bg.blocksY, 0);
+        bg.stale.assign(bg.mean.size(), 0);
+        bg.seen = 0;
+    }
+    const size_t n = bg.mean.size();
+    if (n == 0) return BackgroundState::Learning;
+    frame_block_luma(frame, bg.blocksX, bg.blocksY, bg.luma);
+    bg.regionX1 = bg.regionY1 = -1;
+
+    // Učenje: kumulativni prosjek prvih learnFrames frejmova
+    if (bg.seen < bg.learnFrames) {
+        ++bg.seen;
+        for (size_t i = 0; i < n; ++i) {
+            int target = bg.luma[i] << 8;
+            bg.mean[i] = (uint16_t)(bg.mean[i] + (target - bg.mean[i]) / bg.seen);
+        }
+        return BackgroundState::Learning;
+    }
+
+    bg.changed.resize(n);
+    size_t changedCount = 0;
+    for (size_t i = 0; i < n; ++i) {
+        bg.changed[i] = std::abs((bg.luma[i] << 8) - (int)bg.mean[i]) > (BG_DIFF << 8);
+        changedCount += bg.changed[i];
+    }
+    if (changedCount > BG_MAX_CHANGED * n) {
+        // Ovaj frejm je prvi od novih learnFrames frejmova učenja
+        for (size_t i = 0; i < n; ++i) bg.mean[i] = (uint16_t)(bg.luma[i] << 8);
+        std::fill(bg.stale.begin(), bg.stale.end(), 0);
+        bg.seen = 1;
+        LOG_WARN("[BG] Promijenjeno %zu od %zu blokova, model pozadine se uci ispocetka", changedCount, n);
+        return BackgroundState::Relearn;
+    }
+
+    // Promijenjeni blokovi se uče mnogo sporije, pa karta koja leži na stolu ne nestaje odmah
+    // iz oblasti, a ono što je ostalo u modelu od učenja (sklonjena karta) ipak izblijedi
+    for (size_t i = 0; i < n; ++i) {
+        int shift = bg.changed[i] ? BG_LEARN_CHANGED_SHIFT : BG_LEARN_SHIFT;
+        bg.mean[i] = (uint16_t)(bg.mean[i] + (((bg.luma[i] << 8) - bg.mean[i]) >> shift));
+        if (!bg.changed[i]) bg.stale[i] = 0;
+    }
+
+    int bx0 = 0, by0 = 0, bx1 = 0, by1 = 0;
+    if (changedCount == 0 || largest_changed_region(bg, bx0, by0, bx1, by1) < BG_MIN_BLOCKS) {
+        background_age(bg, false);
+        return BackgroundState::Empty;
+    }
+    bg.regionX0 = bx0, bg.regionY0 = by0, bg.regionX1 = bx1, bg.regionY1 = by1;
+
+    // Okvir u pikselima, poravnat na parne koordinate zbog hrome u YUV frejmovima
+    int x0 = std::max(0, (bx0 - BG_MARGIN_BLOCKS) * BG_BLOCK);
+    int y0 = std::max(0, (by0 - BG_MARGIN_BLOCKS) * BG_BLOCK);
+    int x1 = std::min(frame.width, (bx1 + 1 + BG_MARGIN_BLOCKS) * BG_BLOCK);
+    int y1 = std::min(frame.height, (by1 + 1 + BG_MARGIN_BLOCKS) * BG_BLOCK);
+    if (bx1 + 1 + BG_MARGIN_BLOCKS >= bg.blocksX) x1 = frame.width;   // ostatak van zadnjeg bloka
+    if (by1 + 1 + BG_MARGIN_BLOCKS >= bg.blocksY) y1 = frame.height;
+    roi.x = x0;
+    roi.y = y0;
+    roi.width = (x1 - x0) & ~1;
+    roi.height = (y1 - y0) & ~1;
+    return BackgroundState::Changed;
+}
+
+// Pogled na pravougaonik frejma bez kopiranja (x, y, width, height parni za YUV)
+Frame frame_roi(const Frame& f, const BackgroundRoi& roi) {
+    Frame v = f;
+    v.width = roi.width;
+    v.height = roi.height;
+    v.planes[0] = f.planes[0] + (size_t)roi.y * f.strides[0] + (size_t)roi.x * (f.format == PixelFormat::RGB ? 3 : 1);
+    if (f.format == PixelFormat::NV12) {
+        v.planes[1] = f.planes[1] + (size_t)(roi.y / 2) * f.strides[1] + roi.x;
+    } else if (f.format == PixelFormat::I420) {
+        v.planes[1] = f.planes[1] + (size_t)(roi.y / 2) * f.strides[1] + roi.x / 2;
+        v.planes[2] = f.planes[2] + (size_t)(roi.y / 2) * f.strides[2] + roi.x / 2;
+    }
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// Kapija promjene (--change-gate): kamera iznad stola najčešće šalje isti frejm,
+// pa se iz grubo umanjene lume računa potpis i, dok se ne promijeni, ponavlja se
+// posljednji rezultat bez lokalizacije i matchinga
+// ---------------------------------------------------------------------------
+
+const int GATE_GRID = 16;          // potpis je 16 x 16 srednjih vrijednosti ćelija
+const int GATE_SAMPLES = 8;        // po 8 x 8 uzoraka u ćeliji, ukupno 16K piksela frejma
+const int GATE_DIFF_DEFAULT = 6;   // najveća razlika ćelije (nivoi sive) za "isti" frejm
+
+using FrameSignature = std::array<unsigned char, GATE_GRID * GATE_GRID>;
+
+inline int frame_luma(const Frame& f, int x, int y) {
+    const unsigned char* row = f.planes[0] + (size_t)y * f.strides[0];
+    if (f.format != PixelFormat::RGB) return row[x];
+    const unsigned char* p = row + x * 3;
+    return (p[0] + 2 * p[1] + p[2]) >> 2;
+}
+
+// Srednja luma ćelija iz ravnomjerne rešetke uzoraka (kod malih frejmova se pikseli ponavljaju)
+void frame_signature(const Frame& f, FrameSignature& sig) {
+    const int n = GATE_GRID * GATE_SAMPLES;
+    for (int gy = 0; gy < GATE_GRID; ++gy)
+        for (int gx = 0; gx < GATE_GRID; ++gx) {
+            int sum = 0;
+            for (int sy = 0; sy < GATE_SAMPLES; ++sy) {
+                int y = (int)(((int64_t)(gy * GATE_SAMPLES + sy) * 2 + 1) * f.height / (2 * n));
+                for (int sx = 0; sx < GATE_SAMPLES; ++sx)
+                    sum += frame_luma(f, (int)(((int64_t)(gx * GATE_SAMPLES + sx) * 2 + 1) * f.width / (2 * n)), y);
+            }
+            sig[gy * GATE_GRID + gx] = (unsigned char)((sum + GATE_SAMPLES * GATE_SAMPLES / 2) /
+                                                       (GATE_SAMPLES * GATE_SAMPLES));
+        }
+}
+
+// ---------------------------------------------------------------------------
+// Kvalitet frejma: oštrina (varijansa Laplasijana) u okviru karte i udio
+// presvijetljenih piksela u uglu sa rankom i suitom, prije ispravljanja perspektive
+// i matchinga
+// ---------------------------------------------------------------------------
+
+// Ispravljena karta i njen gornji lijevi ugao (rank i suit)
+const int WARP_W = 200, WARP_H = 300;
+const int CORNER_W = 33, CORNER_H = 90;
+
+enum class QualityMode { Off, Flag, Reject };
+
+const int QUALITY_CARD_PX = WARP_W;       // Laplasijan na razmaku piksela ispravljene karte
+const int QUALITY_CLIP_LEVEL = 250;       // luma od 250 naviše je odsječena
+const float QUALITY_MIN_SHARPNESS = 150;  // najmanja izmjerena oštra karta ima ~340
+const float QUALITY_MAX_CLIPPED = 0.9f;   // više od 90% ugla odsječeno = simboli su izgubljeni
+
+struct FrameQuality {
+    float sharpness = 0;   // varijansa Laplasijana
+    float clipped = 0;     // udio piksela ugla >= QUALITY_CLIP_LEVEL
+};
+
+// Akumulatori jednog reda: Laplasijan 4c - l - r - u - d na razmaku step
+struct QualitySums {
+    int64_t n = 0, sum = 0, sumSq = 0, clipped = 0;
+};
+
+void quality_row_scalar(const unsigned char* row, int stride, int step, int x0, int x1, QualitySums& q) {
+    for (int x = x0; x < x1; ++x) {
+        int c = row[x];
+        int lap = 4 * c - row[x - step] - row[x + step] - row[x - (ptrdiff_t)step * stride] -
+                  row[x + (ptrdiff_t)step * stride];
+        q.sum += lap;
+        q.sumSq += lap * lap;
+        q.clipped += c >= QUALITY_CLIP_LEVEL;
+    }
+    q.n += std::max(0, x1 - x0);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void quality_row_avx2(const unsigned char* row, int stride, int step, int x0, int x1, QualitySums& q) {
+    const ptrdiff_t dy = (ptrdiff_t)step * stride;
+    const __m256i ones = _mm256_set1_epi16(1), clip = _mm256_set1_epi16(QUALITY_CLIP_LEVEL - 1);
+    __m256i sum = _mm256_setzero_si256(), sumSq = _mm256_setzero_si256();
+    int64_t clipped = 0;
+    int x = x0;
+    // Po 16 piksela; int32 zbirovi kvadrata (najviše 2 * 1020^2 po koraku) ne prelivaju za red do 16K piksela
+    for (; x + 16 <= x1; x += 16) {
+        __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(row + x)));
+        __m256i l = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(row + x - step)));
+        __m256i r = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(row + x + step)));
+        __m256i u = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(row + x - dy)));
+        __m256i d = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(row + x + dy)));
+        __m256i lap = _mm256_sub_epi16(_mm256_slli_epi16(c, 2),
+                                       _mm256_add_epi16(_mm256_add_epi16(l, r), _mm256_add_epi16(u, d)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(lap, ones));
+        sumSq = _mm256_add_epi32(sumSq, _mm256_madd_epi16(lap, lap));
+        clipped += __builtin_popcount((uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi16(c, clip))) / 2;
+    }
+    alignas(32) int32_t s[8], s2[8];
+    _mm256_store_si256((__m256i*)s, sum);
+    _mm256_store_si256((__m256i*)s2, sumSq);
+    for (int k = 0; k < 8; ++k) {
+        q.sum += s[k];
+        q.sumSq += s2[k];
+    }
+    q.clipped += clipped;
+    q.n += x - x0;
+    quality_row_scalar(row, stride, step, x, x1, q);
+}
+#else
+void quality_row_avx2(const unsigned char* row, int stride, int step, int x0, int x1, QualitySums& q) {
+    quality_row_scalar(row, stride, step, x0, x1, q);
+}
+#endif
+
+// Okvir tačaka u frejmu, sužen tako da susjedi na razmaku step ostanu u ravni
+struct QualityBox {
+    int x0, y0, x1, y1;
+};
+
+QualityBox quality_box(const Point2f* points, int count, int width, int height, int step) {
+    float minX = width, minY = height, maxX = 0, maxY = 0;
+    for (int i = 0; i < count; ++i) {
+        minX = std::min(minX, points[i].x), maxX = std::max(maxX, points[i].x);
+        minY = std::min(minY, points[i].y), maxY = std::max(maxY, points[i].y);
+    }
+    return {std::max(step, (int)minX), std::max(step, (int)minY), std::min(width - step, (int)maxX + 1),
+            std::min(height - step, (int)maxY + 1)};
+}
+
+// Oštrina iz okvira karte, a odsječeni pikseli iz okvira ugla sa rankom i suitom: bijelo
+// lice karte smije biti odsječeno, frejm je presvijetljen tek kad to stigne i do simbola.
+// Redovi se uzimaju na razmaku step, a pikseli reda svi.
+FrameQuality measure_quality(const unsigned char* gray, int width, int height, int stride,
+                             const std::array<Point2f, 4>& corners) {
+    float shortSide = std::min(distance(corners[0], corners[1]), distance(corners[0], corners[3]));
+    const int step = std::max(1, (int)(shortSide / QUALITY_CARD_PX));
+    const QualityBox card = quality_box(corners.data(), 4, width, height, step);
+
+    // Ugao CORNER_W x CORNER_H ispravljene karte, bilinearno preslikan u frejm kao u
+    // warp_sampled (koji na kraju zrcali kartu vodoravno)
+    auto at = [&](float u, float v) {
+        Point2f top = {corners[0].x + (corners[1].x - corners[0].x) * u, corners[0].y + (corners[1].y - corners[0].y) * u};
+        Point2f bottom = {corners[3].x + (corners[2].x - corners[3].x) * u, corners[3].y + (corners[2].y - corners[3].y) * u};
+        return Point2f{top.x + (bottom.x - top.x) * v, top.y + (bottom.y - top.y) * v};
+    };
+    const float u = (float)CORNER_W / WARP_W, v = (float)CORNER_H / WARP_H;
+    const Point2f ink[4] = {at(1 - u, 0), at(1, 0), at(1, v), at(1 - u, v)};
+    const QualityBox corner = quality_box(ink, 4, width, height, step);
+
+    auto row = cpu_has_avx2() ? quality_row_avx2 : quality_row_scalar;
+    QualitySums q, c;
+    for (int y = card.y0; y < card.y1; y += step) row(gray + (size_t)y * stride, stride, step, card.x0, card.x1, q);
+    for (int y = corner.y0; y < corner.y1; y += step)
+        row(gray + (size_t)y * stride, stride, step, corner.x0, corner.x1, c);
+    FrameQuality fq;
+    if (q.n == 0) return fq;
+    double mean = (double)q.sum / q.n;
+    fq.sharpness = (float)((double)q.sumSq / q.n - mean * mean);
+    if (c.n > 0) fq.clipped = (float)c.clipped / c.n;
+    return fq;
+}
+
+// ---------------------------------------------------------------------------
+// Obrada jednog frejma: lokalizacija karte i izdvajanje ranka i suita
+// ---------------------------------------------------------------------------
+
+const int CORNER_THRESHOLD_WINDOW = 15;   // prozor adaptivnog praga u uglu i simbolima
+
+// Prozor adaptivnog praga za frejm: osmina manje dimenzije (karta je više prozora)
+int frame_threshold_window(int width, int height) {
+    return std::max(15, std::min(width, height) / 8) | 1;
+}
+
+// Koraci 1-7: pronalazi kartu, ispravlja perspektivu i vraća gornji lijevi ugao
+// (CORNER_W x CORNER_H, RGB)
+bool extract_corner(const Frame& frame, std::vector<unsigned char>& corner,
+                    ThresholdMode threshold = ThresholdMode::Fixed,
+                    CornerMethod cornerMethod = CornerMethod::Hull, Localizer localizer = Localizer::Blob,
+                    bool denoise = true, QualityMode quality = QualityMode::Off, bool* lowQuality = nullptr) {
+    int width = frame.width, height = frame.height;
+
+    // 1. Convert to grayscale (sivi i YUV frejmovi koriste luma ravan direktno);
+    // za Otsu se histogram puni u istom prolazu
+    std::vector<unsigned char> grayRGB;
+    const unsigned char* gray = frame.planes[0];
+    int grayStride = frame.strides[0];
+    GrayHistogram hist;
+    GrayHistogram* histOut = threshold == ThresholdMode::Otsu ? &hist : nullptr;
+    if (frame.format == PixelFormat::RGB) {
+        grayRGB.resize(width * height);
+        gray_plane_histogram(frame.planes[0], frame.strides[0], true, width, height, grayRGB.data(), histOut);
+        gray = grayRGB.data();
+        grayStride = width;
+    } else if (histOut) {
+        gray_plane_histogram(frame.planes[0], frame.strides[0], false, width, height, nullptr, histOut);
+    }
+
+    // 2-4. Find card corners: po ivicama, ili kad to ne uspije, kao najveću konturu binarne slike
+    std::array<Point2f, 4> corners;
+    if (localizer != Localizer::Edges || !edge_card_corners(gray, width, height, grayStride, corners)) {
+        if (localizer == Localizer::Edges) LOG_DEBUG("Ivice nisu dale kartu, koristi se najveca kontura");
+
+        // 2. Binarize; uz denoise kao u OpenCV verziji Gauss prije praga, pa otvaranje i
+        // zatvaranje nad bitovima, da šum ne pravi lažne komponente
+        std::vector<unsigned char> binary;
+        if (denoise) {
+            auto blurred = gaussian_blur_plane(gray, width, height, grayStride);
+            BitPlane bits = threshold_bits(blurred.data(), width, height, width, threshold,
+                                           frame_threshold_window(width, height), 120, histOut);
+            open_bits(bits);
+            close_bits(bits);
+            unpack_binary(bits, binary);
+        } else {
+            binary = threshold_plane(gray, width, height, grayStride, threshold,
+                                     frame_threshold_window(width, height), 120, histOut);
+        }
+
+        // 3. Find largest contour (card); praćenje ivica upisuje oznake u binarnu sliku
+        if (debug_enabled()) debug_image("step3_binary.jpg", width, height, 1, binary);
+        auto contour = find_largest_contour(binary, width, height);
+        if (std::fabs(signed_area(contour)) < 100) {
+            LOG_ERROR("Nema dovoljno velika kontura!");
+            return false;
+        }
+
+        // 4. Find corners
+        corners = card_corners(contour, cornerMethod);
+    }
+
+    LOG_DEBUG("Uglovi karte: (%.1f, %.1f) (%.1f, %.1f) (%.1f, %.1f) (%.1f, %.1f)", corners[0].x, corners[0].y,
+              corners[1].x, corners[1].y, corners[2].x, corners[2].y, corners[3].x, corners[3].y);
+
+    // Zamućen ili presvijetljen frejm se odbacuje (ili označava) prije warpa i matchinga
+    if (quality != QualityMode::Off) {
+        FrameQuality fq = measure_quality(gray, width, height, grayStride, corners);
+        LOG_DEBUG("Kvalitet: ostrina %.1f, odsjeceno %.1f%%", fq.sharpness, fq.clipped * 100);
+        const char* problem = fq.sharpness < QUALITY_MIN_SHARPNESS ? "zamucen"
+                            : fq.clipped > QUALITY_MAX_CLIPPED     ? "presvijetljen"
+                                                                   : nullptr;
+        if (problem) {
+            if (quality == QualityMode::Reject) {
+                LOG_WARN("Frejm je %s (ostrina %.1f, odsjeceno %.1f%%), karta se ne prepoznaje", problem,
+                         fq.sharpness, fq.clipped * 100);
+                return false;
+            }
+            LOG_DEBUG("Frejm je %s, rezultat je nepouzdan", problem);
+            if (lowQuality) *lowQuality = true;
+        }
+    }
+
+    // 5. Mark corners on image (kopija cijelog frejma samo za debug sliku)
+    if (debug_enabled()) {
+        std::vector<unsigned char> cornerImage(width * height * 3);
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x) frame_pixel_rgb(frame, x, y, &cornerImage[(y * width + x) * 3]);
+        for (auto& c : corners) {
+            int xx = (int)c.x, yy = (int)c.y;
+            for (int dy = -5; dy <= 5; ++dy) {
+                for (int dx = -5; dx <= 5; ++dx) {
+                    int nx = xx + dx, ny = yy + dy;
+                    if (nx >= 0 && ny >= 0 && nx < width && ny < height) {
+                        int idx = (ny * width + nx) * 3;
+                        cornerImage[idx] = 255;
+                        cornerImage[idx + 1] = 0;
+                        cornerImage[idx + 2] = 0;
+                    }
+                }
+            }
+        }
+        debug_image("step4_corners.jpg", width, height, 3, std::move(cornerImage));
+    }
+
+    // 6. Warp perspective
+    auto warped = warp_frame(frame, corners, WARP_W, WARP_H);
+
+    // 7. Extract top-left corner
+    corner.resize(CORNER_W * CORNER_H * 3);
+    for (int y = 0; y < CORNER_H; ++y)
+        std::copy(&warped[y * WARP_W * 3], &warped[(y * WARP_W + CORNER_W) * 3], &corner[y * CORNER_W * 3]);
+    if (debug_enabled()) {
+        debug_image("step5_warped.jpg", WARP_W, WARP_H, 3, std::move(warped));
+        debug_image("step6_corner_topleft.png", CORNER_W, CORNER_H, 3, corner);
+    }
+    return true;
+}
+
+// Koraci 9-14: izdvaja simbole iz ugla, dijeli ih na rank (gore) i suit (dole)
+// i vraća binarne slike oba dijela (simbol = 0, pozadina = 255) i crvenilo suita;
+// gray_rank/gray_suit dobijaju i sive slike istih dijelova prije binarizacije,
+// a rank_box/suit_box bbox najveće komponente simbola (za features matcher)
+bool split_corner(const std::vector<unsigned char>& cornerImg, int tlw, int tlh,
+                  std::vector<unsigned char>& binary_rank, int& rank_width, int& rank_height,
+                  std::vector<unsigned char>& binary_suit, int& suit_width, int& suit_height,
+                  float& suit_redness, std::vector<unsigned char>* gray_rank = nullptr,
+                  std::vector<unsigned char>* gray_suit = nullptr,
+                  ThresholdMode threshold = ThresholdMode::Fixed, SymbolBox* rank_box = nullptr,
+                  SymbolBox* suit_box = nullptr) {
+    // 9. Convert corner to grayscale
+    std::vector<unsigned char> grayTL(tlw * tlh);
+    GrayHistogram hist;
+    GrayHistogram* histOut = threshold == ThresholdMode::Otsu ? &hist : nullptr;
+    gray_rows_histogram(cornerImg.data(), tlw * 3, true, tlw, 0, tlh, grayTL.data(), histOut);
+
+    // 10. Binarize corner image
+    auto binaryTL = threshold_plane(grayTL.data(), tlw, tlh, tlw, threshold, CORNER_THRESHOLD_WINDOW, 100, histOut);
+
+    // 11. Find symbol area
+    std::vector<Point2f> symbolPoints;
+    for (int y = 0; y < tlh; ++y) {
+        for (int x = 0; x < tlw; ++x) {
+            if (binaryTL[y * tlw + x] == 0) { // znak i broj su crni
+                symbolPoints.push_back({(float)x, (float)y});
+            }
+        }
+    }
+
+    if (symbolPoints.empty()) {
+        LOG_ERROR("Nema detektovanih simbola!");
+        return false;
+    }
+
+    // 12. Crop symbol area
+    float minX = tlw, minY = tlh, maxX = 0, maxY = 0;
+    for (const auto& p : symbolPoints) {
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    int cropW = (int)(maxX - minX + 1);
+    int cropH = (int)(maxY - minY + 1);
+
+    std::vector<unsigned char> finalCrop(cropW * cropH * 3);
+    for (int y = 0; y < cropH; ++y) {
+        for (int x = 0; x < cropW; ++x) {
+            for (int c = 0; c < 3; ++c) {
+                finalCrop[(y * cropW + x) * 3 + c] =
+                    cornerImg[((int)minY + y) * tlw * 3 + ((int)minX + x) * 3 + c];
+            }
+        }
+    }
+
+    if (debug_enabled()) debug_image("step7_symbol_crop.png", cropW, cropH, 3, finalCrop);
+
+    // 13. Split symbol into rank and suit
+    std::vector<unsigned char> rankRGB, suitRGB;
+    split_symbol_image(finalCrop, cropW, cropH, rankRGB, rank_height, suitRGB, suit_height);
+    rank_width = suit_width = cropW;
+
+    // 14. Prepare rank and suit images for matching
+    auto rank_img = rgb_to_grayscale(rankRGB.data(), rank_width, rank_height, 3, histOut);
+    binary_rank = threshold_plane(rank_img.data(), rank_width, rank_height, rank_width, threshold,
+                                  CORNER_THRESHOLD_WINDOW, 120, histOut);
+
+    auto suit_img = rgb_to_grayscale(suitRGB.data(), suit_width, suit_height, 3, histOut);
+    binary_suit = threshold_plane(suit_img.data(), suit_width, suit_height, suit_width, threshold,
+                                  CORNER_THRESHOLD_WINDOW, 120, histOut);
+
+    // Crveno/crno iz RGB piksela simbola, prije nego što grayscale izgubi boju
+    suit_redness = ink_redness(suitRGB.data(), binary_suit);
+    if (gray_rank) *gray_rank = std::move(rank_img);
+    if (gray_suit) *gray_suit = std::move(suit_img);
+    if (rank_box) *rank_box = largest_symbol_box(binary_rank, rank_width, rank_height);
+    if (suit_box) *suit_box = largest_symbol_box(binary_suit, suit_width, suit_height);
+    return true;
+}
+
+
+// ---------------------------------------------------------------------------
+// Benchmark matchera nad označenim slikama (--bench=oznake.txt)
+// ---------------------------------------------------------------------------
+
+struct LabeledImage {
+    std::string path;
+    int rank, suit;
+};
+
+// Format: jedna slika po redu, "putanja Rank Suit" (npr. "karta.jpeg King Hearts")
+bool load_labels(const std::string& filename, std::vector<LabeledImage>& out) {
+    std::ifstream in(filename);
+    if (!in) {
+        LOG_ERROR("Ne mogu da otvorim fajl sa oznakama: %s", filename.c_str());
+        return false;
+    }
+    std::string path, rankName, suitName;
+    while (in >> path >> rankName >> suitName) {
+        LabeledImage li{path, -1, -1};
+        for (int r = 1; r <= 13; ++r)
+            if (putTextString(r) == rankName) li.rank = r;
+        for (int s = 0; s < 4; ++s)
+            if (suitToString(s) == suitName) li.suit = s;
+        if (li.rank < 0 || li.suit < 0) {
+            LOG_ERROR("Nepoznata oznaka: %s %s", rankName.c_str(), suitName.c_str());
+            return false;
+        }
+        out.push_back(li);
+    }
+    return true;
+}
+
+struct BenchSample {
+    LabeledImage label;
+    bool ok = false;
+    std::vector<unsigned char> corner, binary_rank, binary_suit, gray_rank, gray_suit;
+    int rank_width = 0, rank_height = 0, suit_width = 0, suit_height = 0;
+    SymbolBox rank_box, suit_box;
+    std::vector<unsigned char> rank_symbol, suit_symbol;   // isječci simbola za features-pass
+    int rank_symbol_w = 0, rank_symbol_h = 0, suit_symbol_w = 0, suit_symbol_h = 0;
+    unsigned candidates = SUIT_ALL;
+};
+
+using BenchMethod = std::function<void(const BenchSample&, int&, int&)>;
+
+int run_benchmark(const std::string& labelsFile, bool colorPrefilter, ThresholdMode frameThreshold,
+                  ThresholdMode cornerThreshold, CornerMethod cornerMethod, Localizer localizer, bool denoise,
+                  const RawFormat& raw) {
+    std::vector<LabeledImage> labels;
+    if (!load_labels(labelsFile, labels) || labels.empty()) return 1;
+
+    // Benchmark ne snima debug slike (ponovljeni pozivi matchera bi punili red)
+    DebugWriter::instance().mode.store((int)DebugMode::Off);
+
+    // Lokalizacija se radi jednom; mjeri se samo klasifikacija
+    std::vector<BenchSample> samples;
+    for (const auto& li : labels) {
+        BenchSample s;
+        s.label = li;
+        float redness = 0;
+        Frame frame;
+        if (load_frame(li.path, raw, frame)) {
+            s.ok = extract_corner(frame, s.corner, frameThreshold, cornerMethod, localizer, denoise) &&
+                   split_corner(s.corner, CORNER_W, CORNER_H, s.binary_rank, s.rank_width, s.rank_height,
+                                s.binary_suit, s.suit_width, s.suit_height, redness, &s.gray_rank, &s.gray_suit,
+                                cornerThreshold, &s.rank_box, &s.suit_box);
+            if (s.ok && colorPrefilter) s.candidates = suit_candidates(classify_suit_color(redness));
+            if (s.ok) {
+                s.rank_symbol = feature_crop(s.binary_rank, s.rank_width, s.rank_height, &s.rank_box, s.rank_symbol_w,
+                                             s.rank_symbol_h);
+                s.suit_symbol = feature_crop(s.binary_suit, s.suit_width, s.suit_height, &s.suit_box, s.suit_symbol_w,
+                                             s.suit_symbol_h);
+            }
+        }
+        samples.push_back(std::move(s));
+    }
+
+    const std::vector<std::pair<std::string, BenchMethod>> methods = {
+        {"template", [](const BenchSample& s, int& r, int& u) {
+            r = rankMatcher(s.binary_rank, s.rank_width, s.rank_height);
+            u = matchSuit(s.binary_suit, s.suit_width, s.suit_height, s.candidates);
+        }},
+        {"template-shift", [](const BenchSample& s, int& r, int& u) {
+            r = rankMatcherShift(s.binary_rank, s.rank_width, s.rank_height, SHIFT_DEFAULT);
+            u = matchSuitShift(s.binary_suit, s.suit_width, s.suit_height, SHIFT_DEFAULT, s.candidates);
+        }},
+        {"gray-sad", [](const BenchSample& s, int& r, int& u) {
+            r = rankMatcherGray(s.binary_rank, s.gray_rank, s.rank_width, s.rank_height, GrayMetric::Sad);
+            u = matchSuitGray(s.binary_suit, s.gray_suit, s.suit_width, s.suit_height, GrayMetric::Sad, s.candidates);
+        }},
+        {"gray-ncc", [](const BenchSample& s, int& r, int& u) {
+            r = rankMatcherGray(s.binary_rank, s.gray_rank, s.rank_width, s.rank_height, GrayMetric::Ncc);
+            u = matchSuitGray(s.binary_suit, s.gray_suit, s.suit_width, s.suit_height, GrayMetric::Ncc, s.candidates);
+        }},
+        {"fft", [](const BenchSample& s, int& r, int& u) {
+            fftClassify(s.corner, CORNER_W, CORNER_H, r, u, s.candidates);
+        }},
+        {"chamfer", [](const BenchSample& s, int& r, int& u) {
+            r = rankMatcherChamfer(s.binary_rank, s.rank_width, s.rank_height);
+            u = matchSuitChamfer(s.binary_suit, s.suit_width, s.suit_height, s.candidates);
+        }},
+        {"features", [](const BenchSample& s, int& r, int& u) {
+            r = rankMatcherFeatures(s.binary_rank, s.rank_width, s.rank_height, nullptr, &s.rank_box);
+            u = matchSuitFeatures(s.binary_suit, s.suit_width, s.suit_height, s.candidates, nullptr, &s.suit_box);
+        }},
+        // Samo vektor osobina i najbliži centroid, nad već izrezanim simbolima
+        {"features-pass", [](const BenchSample& s, int& r, int& u) {
+            r = s.rank_symbol.empty() ? -1
+                : classify_features(extract_features(s.rank_symbol, s.rank_symbol_w, s.rank_symbol_h),
+                                    rank_feature_centroids(), "Rank");
+            u = s.suit_symbol.empty() ? -1
+                : classify_features(extract_features(s.suit_symbol, s.suit_symbol_w, s.suit_symbol_h),
+                                    suit_feature_centroids(), "Suit", s.candidates);
+        }},
+        {"cnn-scalar", [](const BenchSample& s, int& r, int& u) { cnnClassify(s.corner, r, u, false, s.candidates); }},
+        {"cnn-avx2", [](const BenchSample& s, int& r, int& u) { cnnClassify(s.corner, r, u, true, s.candidates); }},
+    };
+
+    LOG_INFO("Slika: %zu, lokalizovano: %td%s", samples.size(),
+             std::count_if(samples.begin(), samples.end(), [](const BenchSample& s) { return s.ok; }),
+             cpu_has_avx2() ? "" : " (AVX2 nije dostupan, cnn-avx2 koristi skalarni kod)");
+    LOG_RESULT("metod            rank%%   suit%%   oba%%    ns/karti");
+
+    for (const auto& [name, method] : methods) {
+        // Dijagnostika matchera ne ulazi u mjerenje
+        int logLevel = Logger::instance().level.exchange((int)LogLevel::Info);
+
+        int okRank = 0, okSuit = 0, okBoth = 0, localized = 0;
+        for (const auto& s : samples) {
+            if (!s.ok) continue;
+            int r = -1, u = -1;
+            method(s, r, u);   // ujedno zagrijava statičke keševe
+            okRank += r == s.label.rank;
+            okSuit += u == s.label.suit;
+            okBoth += (r == s.label.rank && u == s.label.suit);
+            ++localized;
+        }
+
+        // Ponavljaj dok ne prođe bar 300 ms
+        auto start = std::chrono::steady_clock::now();
+        long long calls = 0;
+        double elapsed = 0;
+        do {
+            for (const auto& s : samples) {
+                if (!s.ok) continue;
+                int r, u;
+                method(s, r, u);
+                ++calls;
+            }
+            elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        } while (calls > 0 && elapsed < 3e8);
+
+        Logger::instance().level.store(logLevel);
+
+        int n = (int)samples.size();
+        char line[128];
+        snprintf(line, sizeof(line), "%-14s %6.1f  %6.1f  %6.1f  %10.0f", name.c_str(),
+                 100.0 * okRank / n, 100.0 * okSuit / n, 100.0 * okBoth / n, calls ? elapsed / calls : 0.0);
+        LOG_RESULT("%s", line);
+    }
+
+    // Batch matcher: svi lokalizovani uzorci jednim pozivom kernela po skupu šablona
+    {
+        const PackedTemplates& ranks = packed_rank_templates();
+        const PackedTemplates& suits = packed_suit_templates();
+        std::vector<const BenchSample*> batch;
+        for (const auto& s : samples)
+            if (s.ok) batch.push_back(&s);
+        std::vector<unsigned> rankCandidates(batch.size(), ~0u), suitCandidates;
+        for (const BenchSample* s : batch) suitCandidates.push_back(s->candidates);
+
+        std::vector<int> rank, suit;
+        std::vector<float> margins;
+        auto run = [&]() {
+            std::vector<std::vector<unsigned char>> rankCrops, suitCrops;
+            for (const BenchSample* s : batch) {
+                rankCrops.push_back(normalize_rank_crop(s->binary_rank, s->rank_width, s->rank_height, ranks));
+                suitCrops.push_back(normalize_suit_crop(s->binary_suit, s->suit_width, s->suit_height, suits));
+            }
+            packed_match_batch(ranks, rankCrops, rankCandidates, rank, margins);
+            packed_match_batch(suits, suitCrops, suitCandidates, suit, margins);
+        };
+
+        int logLevel = Logger::instance().level.exchange((int)LogLevel::Info);
+        run();
+        int okRank = 0, okSuit = 0, okBoth = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            okRank += rank[i] == batch[i]->label.rank;
+            okSuit += suit[i] == batch[i]->label.suit;
+            okBoth += (rank[i] == batch[i]->label.rank && suit[i] == batch[i]->label.suit);
+        }
+        auto start = std::chrono::steady_clock::now();
+        long long calls = 0;
+        double elapsed = 0;
+        do {
+            run();
+            calls += batch.size();
+            elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        } while (calls > 0 && elapsed < 3e8);
+        Logger::instance().level.store(logLevel);
+
+        int n = (int)samples.size();
+        char line[128];
+        snprintf(line, sizeof(line), "%-14s %6.1f  %6.1f  %6.1f  %10.0f", "template-batch",
+                 100.0 * okRank / n, 100.0 * okSuit / n, 100.0 * okBoth / n, calls ? elapsed / calls : 0.0);
+        LOG_RESULT("%s", line);
+
+        // Batch mora dati iste rezultate kao pojedinačni template matcher
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const BenchSample& s = *batch[i];
+            if (rank[i] != rankMatcher(s.binary_rank, s.rank_width, s.rank_height) ||
+                suit[i] != matchSuit(s.binary_suit, s.suit_width, s.suit_height, s.candidates)) {
+                LOG_ERROR("template i template-batch se razlikuju za %s", s.label.path.c_str());
+                return 1;
+            }
+        }
+    }
+
+    // Skalarna i AVX2 putanja moraju dati identične logite
+    for (const auto& s : samples) {
+        if (!s.ok) continue;
+        int32_t a[CNN_N_OUT], b[CNN_N_OUT];
+        auto input = cnn_prepare_input(s.corner);
+        cnn_infer(input, a, false);
+        cnn_infer(input, b, true);
+        if (!std::equal(a, a + CNN_N_OUT, b)) {
+            LOG_ERROR("cnn-scalar i cnn-avx2 se razlikuju za %s", s.label.path.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// Opcije komandne linije
+// ---------------------------------------------------------------------------
+
+enum class MatcherMode { Template, Features, Cnn, Batched, Shift, GraySad, GrayNcc, Fft, Chamfer };
+
+// Broj replika svakog stepena za --pipeline
+struct PipelineConfig {
+    int decoders = 1, localizers = 1, matchers = 1;
+};
+
+struct Options {
+    MatcherMode matcher = MatcherMode::Template;
+    int shift = SHIFT_DEFAULT;  // --shift: pomak šablona za template-shift, u pikselima šablona
+    ThresholdMode frameThreshold = ThresholdMode::Otsu;   // --frame-threshold / --threshold
+    ThresholdMode cornerThreshold = ThresholdMode::Fixed; // --corner-threshold / --threshold
+    CornerMethod cornerMethod = CornerMethod::Hull;       // --corners
+    Localizer localizer = Localizer::Blob;                // --localizer
+    bool denoise = true;                                  // --no-denoise
+    int backgroundFrames = 0;   // --background[=N]: frejmova za učenje praznog stola, 0 = bez modela
+    int changeGate = -1;        // --change-gate[=D]: najveća razlika potpisa za isti frejm, -1 = bez kapije
+    QualityMode quality = QualityMode::Reject;            // --quality
+    std::string benchLabels;    // --bench=FILE: poređenje matchera umjesto obrade karta.jpeg
+    bool colorPrefilter = true; // suit kandidati po boji simbola
+    LogLevel logLevel = LogLevel::Info;
+    DebugMode debugArtifacts = DebugMode::Off;
+    std::vector<std::string> inputs;  // ulazni fajlovi (default: karta.jpeg)
+    RawFormat raw;                    // --format/--width/--height/--stride za sirovi YUV
+    std::string shmName;              // --shm=/ime: frejmovi iz shared-memory prstena
+    std::vector<std::string> watchDirs; // --watch=DIR: novi fajlovi u folderima
+    int workers = 0;                  // --workers=N, 0 = broj jezgara
+    ReaderMode reader = ReaderMode::Mmap; // --reader: čitanje ulaza batch obrade
+    int ioDepth = 8;                  // --io-depth: čitanja u toku za uring/thread
+    bool usePipeline = false;         // --pipeline[=D,L,M]
+    PipelineConfig pipeline;
+};
+
+void print_usage(const char* prog) {
+    std::cerr << "Upotreba: " << prog << " [opcije] [slika...]\n"
+              << "  slika: .jpeg/.png, .pgm/.ppm (P5/P6) ili sirovi YUV .nv12/.i420 (default: karta.jpeg)\n"
+              << "  --matcher=template|template-batch|template-shift|gray-sad|gray-ncc|fft|chamfer|features|cnn\n"
+              << "                                    nacin prepoznavanja ranka i suita (default: template);\n"
+              << "                                    template-batch poredi do 64 karte odjednom bit-pakovano,\n"
+              << "                                    gray-sad/gray-ncc porede sive isjecke bez binarizacije,\n"
+              << "                                    fft trazi sablone u cijelom uglu FFT korelacijom,\n"
+              << "                                    chamfer poredi ivice preko mapa udaljenosti\n"
+              << "  --shift=K                         template-shift trazi najbolji pomak do K piksela (default: 2)\n"
+              << "  --bench=FILE                      tacnost i ns/karti svih matchera nad oznacenim slikama\n"
+              << "  --no-color-prefilter              suit se uvijek poredi sa sva cetiri sablona\n"
+              << "  --threshold=fixed|bradley|sauvola|otsu prag binarizacije za frejm i ugao\n"
+              << "                                    (default: otsu za frejm, fixed za ugao)\n"
+              << "  --frame-threshold=..., --corner-threshold=...  isto, samo za jedan stepen\n"
+              << "  --corners=hull|poly|extrema       uglovi karte: omotac + najmanji pravougaonik (default),\n"
+              << "                                    Douglas-Peucker cetvorougao ili ekstremi x+y / x-y\n"
+              << "  --localizer=blob|edges            karta kao najveca kontura binarne slike (default) ili\n"
+              << "                                    presjek cetiri prave iz Canny + Hough nad umanjenim frejmom\n"
+              << "  --no-denoise                      bez Gaussa prije praga i otvaranja/zatvaranja poslije\n"
+              << "  --quality=reject|flag|off         zamucen ili presvijetljen frejm se odbacuje prije warpa (default),\n"
+              << "                                    samo oznacava kao nepouzdan, ili se kvalitet ne provjerava\n"
+              << "  --background[=N]                  fiksna kamera: prvih N frejmova (default 10) uci prazan sto,\n"
+              << "                                    karta se trazi samo gdje se slika promijenila\n"
+              << "  --change-gate[=D]                 frejm koji se od prethodnog obradjenog razlikuje najvise D\n"
+              << "                                    nivoa po celiji 16x16 (default 6) ponavlja njegov rezultat\n"
+              << "  --log=trace|debug|info|warn|error minimalni nivo poruka (default: info)\n"
+              << "  --debug-artifacts[=low-confidence] snima medjukorake (step*.jpg/png, broj.png, znak.png...);\n"
+              << "                                    uz =low-confidence samo kad je rezultat nesiguran\n"
+              << "  --format=nv12|i420                sirovi YUV ulaz bez obzira na ekstenziju\n"
+              << "  --width=N --height=N [--stride=N] dimenzije sirovog YUV frejma (stride = bajtova po redu Y)\n"
+              << "  --shm=/ime                        frejmovi iz shared-memory prstena (vidi shm_producer.cpp)\n"
+              << "  --watch=DIR                       prepoznaje nove slike u folderu (moze vise puta)\n"
+              << "  --workers=N                       broj radnih niti za --watch (default: broj jezgara)\n"
+              << "  --reader=mmap|uring|thread        citanje ulaza u batch obradi (default: mmap)\n"
+              << "  --io-depth=N                      broj citanja unaprijed za uring/thread (default: 8)\n"
+              << "  --pipeline[=D,L,M]                dekodiranje, lokalizacija i matching u posebnim nitima,\n"
+              << "                                    sa D, L i M replika po stepenu (default: 1,1,1)\n";
+}
+
+bool parse_options(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--matcher=template") {
+            opts.matcher = MatcherMode::Template;
+        } else if (arg == "--matcher=features") {
+            opts.matcher = MatcherMode::Features;
+        } else if (arg == "--matcher=cnn") {
+            opts.matcher = MatcherMode::Cnn;
+        } else if (arg == "--matcher=template-batch") {
+            opts.matcher = MatcherMode::Batched;
+        } else if (arg == "--matcher=template-shift") {
+            opts.matcher = MatcherMode::Shift;
+        } else if (arg == "--matcher=gray-sad") {
+            opts.matcher = MatcherMode::GraySad;
+        } else if (arg == "--matcher=gray-ncc") {
+            opts.matcher = MatcherMode::GrayNcc;
+        } else if (arg == "--matcher=fft") {
+            opts.matcher = MatcherMode::Fft;
+        } else if (arg == "--matcher=chamfer") {
+            opts.matcher = MatcherMode::Chamfer;
+        } else if (arg.rfind("--shift=", 0) == 0) {
+            opts.shift = atoi(arg.c_str() + 8);
+            if (opts.shift < 0 || opts.shift > SHIFT_MAX) {
+                LOG_ERROR("--shift mora biti od 0 do %d", SHIFT_MAX);
+                return false;
+            }
+        } else if (arg.rfind("--threshold=", 0) == 0 || arg.rfind("--frame-threshold=", 0) == 0 ||
+                   arg.rfind("--corner-threshold=", 0) == 0) {
+            std::string value = arg.substr(arg.find('=') + 1);
+            ThresholdMode mode;
+            if (value == "fixed") {
+                mode = ThresholdMode::Fixed;
+            } else if (value == "bradley") {
+                mode = ThresholdMode::Bradley;
+            } else if (value == "sauvola") {
+                mode = ThresholdMode::Sauvola;
+            } else if (value == "otsu") {
+                mode = ThresholdMode::Otsu;
+            } else {
+                LOG_ERROR("Nepoznat prag: %s", value.c_str());
+                return false;
+            }
+            if (arg.rfind("--corner-", 0) != 0) opts.frameThreshold = mode;
+            if (arg.rfind("--frame-", 0) != 0) opts.cornerThreshold = mode;
+        } else if (arg == "--corners=hull") {
+            opts.cornerMethod = CornerMethod::Hull;
+        } else if (arg == "--corners=poly") {
+            opts.cornerMethod = CornerMethod::Poly;
+        } else if (arg == "--corners=extrema") {
+            opts.cornerMethod = CornerMethod::Extrema;
+        } else if (arg == "--localizer=blob") {
+            opts.localizer = Localizer::Blob;
+        } else if (arg == "--localizer=edges") {
+            opts.localizer = Localizer::Edges;
+        } else if (arg == "--background") {
+            opts.backgroundFrames = BG_LEARN_FRAMES_DEFAULT;
+        } else if (arg.rfind("--background=", 0) == 0) {
+            opts.backgroundFrames = atoi(arg.c_str() + 13);
+            if (opts.backgroundFrames < 1) {
+                LOG_ERROR("Neispravan broj frejmova za pozadinu: %s", arg.c_str() + 13);
+                return false;
+            }
+        } else if (arg == "--change-gate") {
+            opts.changeGate = GATE_DIFF_DEFAULT;
+        } else if (arg.rfind("--change-gate=", 0) == 0) {
+            opts.changeGate = atoi(arg.c_str() + 14);
+            if (opts.changeGate < 0) {
+                LOG_ERROR("Neispravan prag kapije: %s", arg.c_str() + 14);
+                return false;
+            }
+        } else if (arg == "--quality=reject") {
+            opts.quality = QualityMode::Reject;
+        } else if (arg == "--quality=flag") {
+            opts.quality = QualityMode::Flag;
+        } else if (arg == "--quality=off") {
+            opts.quality = QualityMode::Off;
+        } else if (arg == "--no-denoise") {
+            opts.denoise = false;
+        } else if (arg == "--no-color-prefilter") {
+            opts.colorPrefilter = false;
+        } else if (arg.rfind("--bench=", 0) == 0) {
+            opts.benchLabels = arg.substr(8);
+        } else if (arg == "--debug-artifacts") {
+            opts.debugArtifacts = DebugMode::All;
+        } else if (arg == "--debug-artifacts=low-confidence") {
+            opts.debugArtifacts = DebugMode::LowConfidence;
+        } else if (arg == "--format=nv12") {
+            opts.raw.format = PixelFormat::NV12;
+        } else if (arg == "--format=i420") {
+            opts.raw.format = PixelFormat::I420;
+        } else if (arg.rfind("--shm=", 0) == 0) {
+            opts.shmName = arg.substr(6);
+        } else if (arg.rfind("--watch=", 0) == 0) {
+            opts.watchDirs.push_back(arg.substr(8));
+        } else if (arg.rfind("--workers=", 0) == 0) {
+            opts.workers = atoi(arg.c_str() + 10);
+        } else if (arg == "--reader=mmap") {
+            opts.reader = ReaderMode::Mmap;
+        } else if (arg == "--reader=uring") {
+            opts.reader = ReaderMode::Uring;
+        } else if (arg == "--reader=thread") {
+            opts.reader = ReaderMode::Thread;
+        } else if (arg == "--pipeline") {
+            opts.usePipeline = true;
+        } else if (arg.rfind("--pipeline=", 0) == 0) {
+            PipelineConfig& c = opts.pipeline;
+            if (sscanf(arg.c_str() + 11, "%d,%d,%d", &c.decoders, &c.localizers, &c.matchers) != 3 ||
+                c.decoders < 1 || c.localizers < 1 || c.matchers < 1) {
+                LOG_ERROR("Neispravan broj replika: %s", arg.c_str() + 11);
+                return false;
+            }
+            opts.usePipeline = true;
+        } else if (arg.rfind("--io-depth=", 0) == 0) {
+            opts.ioDepth = atoi(arg.c_str() + 11);
+        } else if (arg.rfind("--width=", 0) == 0) {
+            opts.raw.width = atoi(arg.c_str() + 8);
+        } else if (arg.rfind("--height=", 0) == 0) {
+            opts.raw.height = atoi(arg.c_str() + 9);
+        } else if (arg.rfind("--stride=", 0) == 0) {
+            opts.raw.stride = atoi(arg.c_str() + 9);
+        } else if (arg.rfind("--", 0) != 0) {
+            opts.inputs.push_back(arg);
+        } else if (arg.rfind("--log=", 0) == 0) {
+            static const std::pair<const char*, LogLevel> levels[] = {
+                {"trace", LogLevel::Trace}, {"debug", LogLevel::Debug}, {"info", LogLevel::Info},
+                {"warn", LogLevel::Warn}, {"error", LogLevel::Error}
+            };
+            auto it = std::find_if(std::begin(levels), std::end(levels),
+                                   [&](const auto& l) { return arg.compare(6, std::string::npos, l.first) == 0; });
+            if (it == std::end(levels)) {
+                LOG_ERROR("Nepoznat nivo logovanja: %s", arg.c_str() + 6);
+                return false;
+            }
+            opts.logLevel = it->second;
+        } else {
+            LOG_ERROR("Nepoznata opcija: %s", arg.c_str());
+            return false;
+        }
+    }
+    if (opts.inputs.empty()) opts.inputs.push_back("karta.jpeg");
+    bool batchedFiles = opts.matcher == MatcherMode::Batched && opts.shmName.empty();
+    if ((opts.backgroundFrames > 0 || opts.changeGate >= 0) &&
+        (opts.usePipeline || !opts.watchDirs.empty() || batchedFiles))
+        LOG_WARN("--background i --change-gate se koriste samo uz --shm i obradu slika redom, ovdje se ignorisu");
+    return true;
+}
+
+// Rezultat prepoznavanja jednog frejma
+struct CardResult {
+    bool located = false;             // karta i simboli ugla su pronađeni
+    int rank = -1;                    // kodiranje putTextString, -1 = nije prepoznat
+    int suit = -1;                    // kodiranje suitToString, -1 = nije prepoznat
+    float rankMargin = 0, suitMargin = 0; // relativna prednost najboljeg kandidata
+    bool lowQuality = false;          // zamućen ili presvijetljen frejm (--quality=flag)
+};
+
+// Ugao karte i binarni rank/suit nakon lokalizacije (koraci 1-14)
+struct LocalizedCard {
+    std::vector<unsigned char> corner;        // CORNER_W x CORNER_H, RGB
+    std::vector<unsigned char> binaryRank, binarySuit;
+    std::vector<unsigned char> grayRank, graySuit;    // iste dimenzije, prije binarizacije
+    int rankWidth = 0, rankHeight = 0, suitWidth = 0, suitHeight = 0;
+    SymbolBox rankBox, suitBox;               // samo za features matcher
+    float redness = 0;
+    bool hasColor = true;                     // sivi frejmovi nemaju boju
+    bool lowQuality = false;                  // vidi CardResult::lowQuality
+};
+
+bool matcher_needs_symbols(const Options& opts) {
+    return opts.matcher != MatcherMode::Fft && opts.matcher != MatcherMode::Cnn;
+}
+
+// Koraci 1-14; false ako karta ili simboli nisu pronađeni. Matcheri koji rade
+// nad cijelim uglom (cnn, fft) ne traže simbole: tada neuspjelo dijeljenje samo
+// isključuje izbor suita po boji. Sa modelom pozadine karta se traži samo u
+// oblasti koja se promijenila u odnosu na prazan sto.
+bool localize_frame(const Frame& frame, LocalizedCard& card, const Options& opts, BackgroundModel* bg = nullptr) {
+    Frame view = frame;
+    if (bg) {
+        BackgroundRoi roi;
+        BackgroundState state = background_update(*bg, frame, roi);
+        if (state == BackgroundState::Empty) {
+            LOG_DEBUG("[BG] Nema promjene u odnosu na pozadinu");
+            return false;
+        }
+        if (state == BackgroundState::Changed) {
+            LOG_DEBUG("[BG] Promjena %dx%d na (%d, %d)", roi.width, roi.height, roi.x, roi.y);
+            view = frame_roi(frame, roi);
+        }
+    }
+
+    // 1-7. Locate card and extract top-left corner
+    bool found = extract_corner(view, card.corner, opts.frameThreshold, opts.cornerMethod, opts.localizer,
+                                opts.denoise, opts.quality, &card.lowQuality);
+    if (bg && bg->regionX1 >= 0) background_age(*bg, found);
+    if (!found) return false;
+
+    // 8-14. Split corner into rank and suit
+    card.hasColor = frame.format != PixelFormat::Gray;
+    bool features = opts.matcher == MatcherMode::Features;
+    bool split = split_corner(card.corner, CORNER_W, CORNER_H, card.binaryRank, card.rankWidth, card.rankHeight,
+                              card.binarySuit, card.suitWidth, card.suitHeight, card.redness, &card.grayRank,
+                              &card.graySuit, opts.cornerThreshold, features ? &card.rankBox : nullptr,
+                              features ? &card.suitBox : nullptr);
+    if (!split && !matcher_needs_symbols(opts)) {
+        card.hasColor = false;
+        return true;
+    }
+    return split;
+}
+
+// Boja suita: sa dovoljnom marginom porede se samo dva šablona iste boje
+// (sivi frejmovi nemaju boju, tu se porede sva četiri)
+unsigned card_suit_candidates(const LocalizedCard& card, const Options& opts) {
+    if (!opts.colorPrefilter || !card.hasColor) return SUIT_ALL;
+    SuitColor color = classify_suit_color(card.redness);
+    LOG_DEBUG("Suit redness: %g -> %s", card.redness,
+              color == SuitColor::Red ? "red" : color == SuitColor::Black ? "black" : "unknown");
+    return suit_candidates(color);
+}
+
+// Koraci 15-16 za n lokalizovanih karata jednim batch kernelom (--matcher=template-batch).
+// Ako je debugFrames zadat, debug slike karte i idu u debugFrames[i] umjesto u tekući frejm.
+void match_cards_batched(const LocalizedCard* cards, CardResult* results, size_t n, const Options& opts,
+                         std::vector<DebugImage>* debugFrames = nullptr) {
+    const PackedTemplates& ranks = packed_rank_templates();
+    const PackedTemplates& suits = packed_suit_templates();
+    std::vector<std::vector<unsigned char>> rankCrops(n), suitCrops(n);
+    std::vector<unsigned> rankCandidates(n, ~0u), suitCandidates(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (debugFrames) debug_resume_frame(std::move(debugFrames[i]));
+        suitCandidates[i] = card_suit_candidates(cards[i], opts);
+        rankCrops[i] = normalize_rank_crop(cards[i].binaryRank, cards[i].rankWidth, cards[i].rankHeight, ranks);
+        suitCrops[i] = normalize_suit_crop(cards[i].binarySuit, cards[i].suitWidth, cards[i].suitHeight, suits);
+        if (debugFrames) debugFrames[i] = debug_take_frame();
+    }
+
+    std::vector<int> rank, suit;
+    std::vector<float> rankMargin, suitMargin;
+    packed_match_batch(ranks, rankCrops, rankCandidates, rank, rankMargin);
+    packed_match_batch(suits, suitCrops, suitCandidates, suit, suitMargin);
+    for (size_t i = 0; i < n; ++i) {
+        results[i].rank = rank[i];
+        results[i].suit = suit[i];
+        results[i].rankMargin = rankMargin[i];
+        results[i].suitMargin = suitMargin[i];
+    }
+}
+
+// Koraci 15-16: rank i suit lokalizovane karte
+void match_card(const LocalizedCard& card, const Options& opts, CardResult& result) {
+    if (opts.matcher == MatcherMode::Batched) {
+        match_cards_batched(&card, &result, 1, opts);
+        LOG_DEBUG("Margin rank: %.3f, suit: %.3f", result.rankMargin, result.suitMargin);
+        return;
+    }
+    unsigned candidates = card_suit_candidates(card, opts);
+
+    if (opts.matcher == MatcherMode::Cnn) {
+        cnnClassify(card.corner, result.rank, result.suit, true, candidates, &result.rankMargin, &result.suitMargin);
+    } else if (opts.matcher == MatcherMode::Fft) {
+        fftClassify(card.corner, CORNER_W, CORNER_H, result.rank, result.suit, candidates, &result.rankMargin,
+                    &result.suitMargin);
+    } else if (opts.matcher == MatcherMode::GraySad || opts.matcher == MatcherMode::GrayNcc) {
+        GrayMetric metric = opts.matcher == MatcherMode::GraySad ? GrayMetric::Sad : GrayMetric::Ncc;
+        result.rank = rankMatcherGray(card.binaryRank, card.grayRank, card.rankWidth, card.rankHeight, metric,
+                                      &result.rankMargin);
+        result.suit = matchSuitGray(card.binarySuit, card.graySuit, card.suitWidth, card.suitHeight, metric,
+                                    candidates, &result.suitMargin);
+    } else if (opts.matcher == MatcherMode::Chamfer) {
+        result.rank = rankMatcherChamfer(card.binaryRank, card.rankWidth, card.rankHeight, &result.rankMargin);
+        result.suit = matchSuitChamfer(card.binarySuit, card.suitWidth, card.suitHeight, candidates,
+                                       &result.suitMargin);
+    } else if (opts.matcher == MatcherMode::Shift) {
+        result.rank = rankMatcherShift(card.binaryRank, card.rankWidth, card.rankHeight, opts.shift, &result.rankMargin);
+        result.suit = matchSuitShift(card.binarySuit, card.suitWidth, card.suitHeight, opts.shift, candidates,
+                                     &result.suitMargin);
+    } else {
+        // 15. Match rank
+        result.rank = (opts.matcher == MatcherMode::Features)
+            ? rankMatcherFeatures(card.binaryRank, card.rankWidth, card.rankHeight, &result.rankMargin, &card.rankBox)
+            : rankMatcher(card.binaryRank, card.rankWidth, card.rankHeight, &result.rankMargin);
+
+        // 16. Match suit
+        result.suit = (opts.matcher == MatcherMode::Features)
+            ? matchSuitFeatures(card.binarySuit, card.suitWidth, card.suitHeight, candidates, &result.suitMargin,
+                                &card.suitBox)
+            : matchSuit(card.binarySuit, card.suitWidth, card.suitHeight, candidates, &result.suitMargin);
+    }
+    LOG_DEBUG("Margin rank: %.3f, suit: %.3f", result.rankMargin, result.suitMargin);
+}
+
+// Za --debug-artifacts=low-confidence
+bool low_confidence(const CardResult& result) {
+    return !result.located || result.lowQuality || result.rank == -1 || result.suit == -1 ||
+           std::min(result.rankMargin, result.suitMargin) < LOW_CONFIDENCE_MARGIN;
+}
+
+// Koraci 1-16 za jedan frejm; vraća false ako karta nije lokalizovana
+bool recognize_frame(const Frame& frame, const Options& opts, CardResult& result, BackgroundModel* bg = nullptr) {
+    result = CardResult();
+    LocalizedCard card;
+    result.located = localize_frame(frame, card, opts, bg);
+    result.lowQuality = card.lowQuality;
+    if (result.located) match_card(card, opts, result);
+    debug_end_frame(low_confidence(result));
+    return result.located;
+}
+
+// Ispisuje rezultat jednom porukom, pa se rezultati iz različitih niti ne miješaju
+void print_result(const CardResult& result, const std::string& header = "") {
+    if (!result.located) return;
+    std::string text = header.empty() ? "" : "== " + header + "\n";
+    if (result.rank != -1) text += "Detektovani rank: " + putTextString(result.rank) + "\n";
+    text += (result.suit != -1) ? "Detektovani suit: " + suitToString(result.suit) : "Suit nije prepoznat!";
+    if (result.lowQuality) text += "\nUpozorenje: frejm je zamucen ili presvijetljen, rezultat je nepouzdan";
+    LOG_RESULT("%s", text.c_str());
+}
+
+// Stanje kapije promjene za jedan tok frejmova
+struct ChangeGate {
+    int maxDiff = GATE_DIFF_DEFAULT;
+    bool valid = false;                // signature i result pripadaju obrađenom frejmu
+    int width = 0, height = 0;
+    FrameSignature signature{};
+    CardResult result;
+    uint64_t reused = 0;
+};
+
+// true ako je frejm isti kao posljednji obrađeni (tada važi gate.result). Inače se
+// potpis pamti, a pozivalac poslije obrade upisuje rezultat sa gate_store.
+bool gate_unchanged(ChangeGate& gate, const Frame& frame) {
+    FrameSignature sig;
+    frame_signature(frame, sig);
+    if (gate.valid && frame.width == gate.width && frame.height == gate.height) {
+        int diff = 0;
+        for (size_t i = 0; i < sig.size(); ++i) diff = std::max(diff, std::abs(sig[i] - gate.signature[i]));
+        if (diff <= gate.maxDiff) {
+            LOG_TRACE("[GATE] Razlika %d nivoa, ponavlja se prethodni rezultat", diff);
+            ++gate.reused;
+            return true;
+        }
+        LOG_DEBUG("[GATE] Promjena %d nivoa, frejm se obradjuje", diff);
+    }
+    gate.valid = false;
+    gate.width = frame.width;
+    gate.height = frame.height;
+    gate.signature = sig;
+    return false;
+}
+
+void gate_store(ChangeGate& gate, const CardResult& result) {
+    gate.result = result;
+    gate.valid = true;
+}
+
+// Model pozadine i kapija promjene za jedan tok frejmova; nullptr ako su isključeni
+struct StreamState {
+    std::unique_ptr<BackgroundModel> bg;
+    std::unique_ptr<ChangeGate> gate;
+};
+
+StreamState stream_state(const Options& opts) {
+    StreamState stream;
+    if (opts.backgroundFrames > 0) {
+        stream.bg.reset(new BackgroundModel());
+        stream.bg->learnFrames = opts.backgroundFrames;
+    }
+    if (opts.changeGate >= 0) {
+        stream.gate.reset(new ChangeGate());
+        stream.gate->maxDiff = opts.changeGate;
+    }
+    return stream;
+}
+
+#ifdef __linux__
+// Pogled na frejm u slotu prstena, bez kopiranja; false ako zaglavlje nije ispravno
+bool frame_from_slot(FrameSlotHeader* slot, uint32_t slotBytes, Frame& f) {
+    if (slot->format > FRAME_I420 || slot->width == 0 || slot->height == 0) return false;
+    size_t capacity = slotBytes - FRAME_SLOT_DATA_OFFSET;
+    int w = slot->width, h = slot->height, stride = slot->stride;
+    size_t luma = (size_t)stride * h, needed = luma;
+    f = Frame();
+    f.format = (PixelFormat)slot->format;
+    f.width = w;
+    f.height = h;
+    f.planes[0] = frame_slot_data(slot);
+    f.strides[0] = stride;
+    switch (f.format) {
+    case PixelFormat::RGB:
+        if (stride < w * 3) return false;
+        break;
+    case PixelFormat::Gray:
+        if (stride < w) return false;
+        break;
+    case PixelFormat::NV12:
+        if (stride < w || (w | h) & 1) return false;
+        f.planes[1] = f.planes[0] + luma;
+        f.strides[1] = stride;
+        needed += luma / 2;
+        break;
+    case PixelFormat::I420:
+        if (stride < w || (w | h) & 1) return false;
+        f.planes[1] = f.planes[0] + luma;
+        f.planes[2] = f.planes[1] + luma / 4;
+        f.strides[1] = f.strides[2] = stride / 2;
+        needed += luma / 2;
+        break;
+    }
+    return needed <= slot->bytes && needed <= capacity;
+}
+
+// Prepoznavanje iz shared-memory prstena (--shm=/ime, vidi frame_ring.h).
+// Uvijek se obrađuje najnoviji objavljeni frejm, direktno u slotu; frejmovi koje
+// proizvođač u međuvremenu prestigne se preskaču, a rezultat frejma čiji je slot
+// prepisan tokom obrade se odbacuje.
+int run_shm_consumer(const std::string& name, const Options& opts) {
+    // Proizvođač možda još nije napravio prsten: čeka se do 10 s
+    FrameRingHeader* ring = nullptr;
+    size_t size = 0;
+    for (int attempt = 0; attempt < 100 && !ring; ++attempt) {
+        if (attempt) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) continue;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(FrameRingHeader)) {
+            void* mem = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mem != MAP_FAILED) {
+                auto* hdr = static_cast<FrameRingHeader*>(mem);
+                if (hdr->magic.load(std::memory_order_acquire) == FRAME_RING_MAGIC &&
+                    hdr->version == FRAME_RING_VERSION &&
+                    frame_ring_size(hdr->slotCount, hdr->slotBytes) <= (size_t)st.st_size) {
+                    ring = hdr;
+                    size = st.st_size;
+                } else {
+                    munmap(mem, st.st_size);
+                }
+            }
+        }
+        close(fd);
+    }
+    if (!ring) {
+        LOG_ERROR("Ne mogu da otvorim prsten frejmova: %s", name.c_str());
+        return 1;
+    }
+    LOG_DEBUG("[SHM] %s: %u slotova x %u bajtova", name.c_str(), ring->slotCount, ring->slotBytes);
+
+    StreamState stream = stream_state(opts);
+    BackgroundModel* bg = stream.bg.get();
+    ChangeGate* gate = stream.gate.get();
+
+    uint32_t seen = 0;
+    uint64_t published = 0, next = 0;
+    uint64_t processed = 0, skipped = 0, torn = 0;
+    while (true) {
+        uint32_t pub = ring->published.load(std::memory_order_acquire);
+        if (pub == seen) {
+            if (ring->closed.load(std::memory_order_acquire)) break;
+            frame_ring_wait(ring, seen, 100);
+            continue;
+        }
+        published += (uint32_t)(pub - seen);
+        seen = pub;
+
+        uint64_t n = published - 1;
+        skipped += n - next;
+        next = n + 1;
+
+        FrameSlotHeader* slot = frame_ring_slot(ring, n);
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        Frame frame;
+        if (seq != 2 * n + 2 || !frame_from_slot(slot, ring->slotBytes, frame)) {
+            ++torn;
+            continue;
+        }
+
+        CardResult result;
+        bool reused = gate && gate_unchanged(*gate, frame);
+        if (reused) {
+            result = gate->result;
+        } else {
+            recognize_frame(frame, opts, result, bg);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) != seq) {
+            ++torn;
+            if (gate) gate->valid = false;
+            LOG_WARN("[SHM] Frejm %llu je prepisan tokom obrade, rezultat odbacen", (unsigned long long)n);
+            continue;
+        }
+        if (gate && !reused) gate_store(*gate, result);
+        ++processed;
+        print_result(result, "frejm " + std::to_string(n));
+    }
+
+    LOG_INFO("[SHM] Obradjeno: %llu, preskoceno: %llu, prepisano: %llu", (unsigned long long)processed,
+             (unsigned long long)skipped, (unsigned long long)torn);
+    if (gate) LOG_INFO("[GATE] Nepromijenjenih frejmova (ponovljen rezultat): %llu", (unsigned long long)gate->reused);
+    munmap(ring, size);
+    return 0;
+}
+#endif
+
+#ifdef __linux__
+// ---------------------------------------------------------------------------
+// Praćenje foldera (--watch=DIR): inotify javlja kad je fajl zatvoren nakon
+// pisanja (ili premješten u folder), putanja ide u red, a radne niti mapiraju
+// fajl, prepoznaju kartu i odmah ispisuju rezultat.
+// ---------------------------------------------------------------------------
+
+const char* const WATCH_EXTENSIONS[] = {".jpg", ".jpeg", ".png", ".bmp", ".pgm", ".ppm", ".nv12", ".i420", ".yuv"};
+
+volatile std::sig_atomic_t g_stopRequested = 0;
+
+void request_stop(int) { g_stopRequested = 1; }
+
+struct WatchJob {
+    std::string path;
+    std::chrono::steady_clock::time_point queued;
+};
+
+class JobQueue {
+public:
+    void push(WatchJob job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+
+    // false kad je red zatvoren i prazan
+    bool pop(WatchJob& job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return closed || !jobs.empty(); });
+        if (jobs.empty()) return false;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        cv.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<WatchJob> jobs;
+    bool closed = false;
+};
+
+bool is_watched_image(const std::string& name) {
+    if (name.empty() || name[0] == '.') return false; // privremeni fajlovi tokom kopiranja
+    for (const char* ext : WATCH_EXTENSIONS)
+        if (has_extension(name, ext)) return true;
+    return false;
+}
+
+void watch_worker(JobQueue& queue, const Options& opts) {
+    bandsOnCaller = true; // radnih niti je već koliko i jezgara
+    WatchJob job;
+    while (queue.pop(job)) {
+        std::shared_ptr<const unsigned char> data;
+        size_t size;
+        Frame frame;
+        // Fajl piše drugi proces: mapiranje bi pri skraćivanju fajla tokom dekodiranja
+        // dalo SIGBUS, pa se fajl kopira u bafer
+        if (!read_file(job.path, data, size)) {
+            LOG_ERROR("Greska pri ucitavanju slike: %s", job.path.c_str());
+            continue;
+        }
+        if (!decode_frame(job.path, data, size, opts.raw, frame)) continue;
+        data.reset(); // JPEG/PNG su dekodirani, bafer više nije potreban
+
+        CardResult result;
+        if (!recognize_frame(frame, opts, result))
+            LOG_WARN("Karta nije pronadjena: %s", job.path.c_str());
+        print_result(result, job.path);
+        LOG_DEBUG("[WATCH] %s: %.2f ms od zatvaranja fajla", job.path.c_str(),
+                  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.queued).count());
+    }
+}
+
+int run_watch(const Options& opts) {
+    int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (fd < 0) {
+        LOG_ERROR("inotify nije dostupan");
+        return 1;
+    }
+    std::vector<std::pair<int, std::string>> dirs;
+    for (const auto& dir : opts.watchDirs) {
+        int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            LOG_ERROR("Ne mogu da pratim folder: %s", dir.c_str());
+            close(fd);
+            return 1;
+        }
+        dirs.push_back({wd, dir.back() == '/' ? dir : dir + "/"});
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    JobQueue queue;
+    int workers = opts.workers > 0 ? opts.workers : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; ++i) threads.emplace_back(watch_worker, std::ref(queue), std::cref(opts));
+    LOG_INFO("Pracenje %zu foldera, %d radnih niti (Ctrl+C za kraj)", dirs.size(), workers);
+
+    alignas(inotify_event) char buf[64 * 1024];
+    while (!g_stopRequested) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        ssize_t len = read(fd, buf, sizeof(buf));
+        auto now = std::chrono::steady_clock::now();
+        for (ssize_t off = 0; off < len;) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+            off += sizeof(inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) LOG_WARN("[WATCH] Red inotify dogadjaja je prepunjen, neki fajlovi su propusteni");
+            if (!ev->len || (ev->mask & IN_ISDIR) || !is_watched_image(ev->name)) continue;
+            for (const auto& [wd, dir] : dirs)
+                if (wd == ev->wd) queue.push({dir + ev->name, now});
+        }
+    }
+
+    queue.close();
+    for (auto& t : threads) t.join();
+    close(fd);
+    return 0;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Pipeline (--pipeline=D,L,M): dekodiranje -> lokalizacija/warp -> matching,
+// svaki stepen u svojim nitima. Frejm k obrađuje replika k % R svakog stepena,
+// pa između svake dvije replike susjednih stepena postoji tačno jedan
+// proizvođač i jedan potrošač (lock-free SPSC red). Glavna nit ispisuje
+// rezultate redom i vraća stavke u pool replike dekodera koja ih je dala.
+// ---------------------------------------------------------------------------
+
+// Ograničeni red za jednog proizvođača i jednog potrošača
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : slots(round_up(capacity + 1)), mask(slots.size() - 1) {}
+
+    bool try_push(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (((t + 1) & mask) == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (((t + 1) & mask) == cachedHead) return false;
+        }
+        slots[t] = std::move(value);
+        tail.store((t + 1) & mask, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        value = std::move(slots[h]);
+        head.store((h + 1) & mask, std::memory_order_release);
+        return true;
+    }
+
+    // Blokirajuće varijante: kratko vrtenje pa prepuštanje procesora
+    void push(T value) {
+        for (int spins = 0; !try_push(value); ++spins)
+            if (spins > 64) std::this_thread::yield();
+    }
+
+    T pop() {
+        T value;
+        for (int spins = 0; !try_pop(value); ++spins)
+            if (spins > 64) std::this_thread::yield();
+        return value;
+    }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    std::vector<T> slots;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;     // potrošačeva kopija tail-a
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;     // proizvođačeva kopija head-a
+};
+
+const size_t PIPELINE_QUEUE = 4;         // kapacitet reda između dvije replike
+const size_t PIPELINE_ITEMS = 8;         // stavki u pool-u po replici dekodera
+
+// Stavka koja putuje kroz pipeline; vektori zadržavaju kapacitet između frejmova
+struct PipelineItem {
+    size_t index = 0;
+    Frame frame;
+    LocalizedCard card;
+    CardResult result;
+    std::vector<DebugImage> debugImages;
+    bool decoded = false;
+};
+
+class Pipeline {
+public:
+    Pipeline(const std::vector<std::string>& paths, const Options& opts)
+        : paths(paths), opts(opts), cfg(opts.pipeline), items(cfg.decoders * PIPELINE_ITEMS) {
+        auto make = [](size_t n) {
+            std::vector<std::unique_ptr<SpscQueue<PipelineItem*>>> q;
+            for (size_t i = 0; i < n; ++i) q.emplace_back(new SpscQueue<PipelineItem*>(PIPELINE_QUEUE));
+            return q;
+        };
+        decodeToLocalize = make(cfg.decoders * cfg.localizers);
+        localizeToMatch = make(cfg.localizers * cfg.matchers);
+        matchToEmit = make(cfg.matchers);
+        for (int d = 0; d < cfg.decoders; ++d) {
+            freeItems.emplace_back(new SpscQueue<PipelineItem*>(PIPELINE_ITEMS));
+            for (size_t i = 0; i < PIPELINE_ITEMS; ++i) freeItems[d]->push(&items[d * PIPELINE_ITEMS + i]);
+        }
+    }
+
+    int run() {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int r = 0; r < cfg.decoders; ++r) threads.emplace_back(&Pipeline::decode_stage, this, r);
+        for (int r = 0; r < cfg.localizers; ++r) threads.emplace_back(&Pipeline::localize_stage, this, r);
+        for (int r = 0; r < cfg.matchers; ++r) threads.emplace_back(&Pipeline::match_stage, this, r);
+
+        // Ispis redom i povrat stavki dekoderima
+        int status = 0;
+        for (size_t k = 0; k < paths.size(); ++k) {
+            PipelineItem* item = matchToEmit[k % cfg.matchers]->pop();
+            if (item->result.located) {
+                print_result(item->result, paths.size() > 1 ? paths[k] : "");
+            } else {
+                if (paths.size() > 1) LOG_RESULT("== %s", paths[k].c_str());
+                status = 1;
+            }
+            item->frame = Frame(); // oslobađa dekodirane piksele
+            freeItems[k % cfg.decoders]->push(item);
+        }
+        for (auto& t : threads) t.join();
+
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("[PIPELINE] %zu frejmova za %.1f ms (%.1f fps); rad po stepenu: dekodiranje %.1f ms, "
+                 "lokalizacija %.1f ms, matching %.1f ms",
+                 paths.size(), totalMs, paths.size() * 1000.0 / std::max(totalMs, 1e-3), busyNs[0] / 1e6,
+                 busyNs[1] / 1e6, busyNs[2] / 1e6);
+        return status;
+    }
+
+private:
+    void add_busy(int stage, std::chrono::steady_clock::time_point since) {
+        busyNs[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since)
+                             .count();
+    }
+
+    void decode_stage(int r) {
+        for (size_t k = r; k < paths.size(); k += cfg.decoders) {
+            PipelineItem* item = freeItems[r]->pop();
+            auto t0 = std::chrono::steady_clock::now();
+            item->index = k;
+            item->frame = Frame();
+            item->decoded = load_frame(paths[k], opts.raw, item->frame);
+            add_busy(0, t0);
+            decodeToLocalize[r * cfg.localizers + k % cfg.localizers]->push(item);
+        }
+    }
+
+    void localize_stage(int r) {
+        bandsOnCaller = true; // stepeni pipeline-a već rade paralelno
+        for (size_t k = r; k < paths.size(); k += cfg.localizers) {
+            PipelineItem* item = decodeToLocalize[(k % cfg.decoders) * cfg.localizers + r]->pop();
+            auto t0 = std::chrono::steady_clock::now();
+            item->result = CardResult();
+            item->result.located = item->decoded && localize_frame(item->frame, item->card, opts);
+            item->result.lowQuality = item->card.lowQuality;
+            item->debugImages = debug_take_frame();
+            add_busy(1, t0);
+            localizeToMatch[r * cfg.matchers + k % cfg.matchers]->push(item);
+        }
+    }
+
+    void match_stage(int r) {
+        for (size_t k = r; k < paths.size(); k += cfg.matchers) {
+            PipelineItem* item = localizeToMatch[(k % cfg.localizers) * cfg.matchers + r]->pop();
+            auto t0 = std::chrono::steady_clock::now();
+            if (item->result.located) match_card(item->card, opts, item->result);
+            debug_resume_frame(std::move(item->debugImages));
+            debug_end_frame(low_confidence(item->result));
+            add_busy(2, t0);
+            matchToEmit[r]->push(item);
+        }
+    }
+
+    const std::vector<std::string>& paths;
+    const Options& opts;
+    const PipelineConfig cfg;
+    std::vector<PipelineItem> items;
+    std::vector<std::unique_ptr<SpscQueue<PipelineItem*>>> decodeToLocalize, localizeToMatch, matchToEmit, freeItems;
+    std::atomic<uint64_t> busyNs[3] = {};
+};
+
+// --matcher=template-batch: lokalizuje do BATCH_MATCH_SIZE frejmova, pa ih poredi
+// sa šablonima odjednom; rezultati se ispisuju redom ulaza
+template <typename Reader>
+int process_inputs_batched(Reader& reader, const Options& opts) {
+    int status = 0;
+    std::vector<std::string> paths;
+    std::vector<LocalizedCard> cards;
+    std::vector<CardResult> results;
+    std::vector<std::vector<DebugImage>> debugFrames;
+    std::vector<bool> readOk;
+    while (!reader.done()) {
+        paths.clear();
+        readOk.assign(BATCH_MATCH_SIZE, false);
+        cards.assign(BATCH_MATCH_SIZE, LocalizedCard());
+        results.assign(BATCH_MATCH_SIZE, CardResult());
+        debugFrames.assign(BATCH_MATCH_SIZE, {});
+        size_t n = 0;
+        for (; n < BATCH_MATCH_SIZE && !reader.done(); ++n) {
+            paths.push_back(reader.path());
+            Frame frame;
+            if (!reader.read(opts.raw, frame)) {
+                status = 1;
+            } else {
+                readOk[n] = true;
+                results[n].located = localize_frame(frame, cards[n], opts);
+            }
+            debugFrames[n] = debug_take_frame();
+        }
+
+        // Samo lokalizovane karte idu u batch
+        std::vector<size_t> located;
+        std::vector<LocalizedCard> batch;
+        for (size_t i = 0; i < n; ++i)
+            if (results[i].located) {
+                located.push_back(i);
+                batch.push_back(std::move(cards[i]));
+            }
+        std::vector<CardResult> matched(batch.size());
+        std::vector<std::vector<DebugImage>> batchDebug(batch.size());
+        for (size_t j = 0; j < located.size(); ++j) batchDebug[j] = std::move(debugFrames[located[j]]);
+        match_cards_batched(batch.data(), matched.data(), batch.size(), opts, batchDebug.data());
+        for (size_t j = 0; j < located.size(); ++j) {
+            matched[j].located = true;
+            matched[j].lowQuality = batch[j].lowQuality;
+            results[located[j]] = matched[j];
+            debugFrames[located[j]] = std::move(batchDebug[j]);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            debug_resume_frame(std::move(debugFrames[i]));
+            debug_end_frame(low_confidence(results[i]));
+            if (opts.inputs.size() > 1) LOG_RESULT("== %s", paths[i].c_str());
+            if (!readOk[i]) continue;
+            if (!results[i].located) status = 1;
+            print_result(results[i]);
+        }
+    }
+    return status;
+}
+
+// Obrada ulaznih fajlova redom; Reader je BatchReader ili PrefetchReader
+template <typename Reader>
+int process_inputs(Reader& reader, const Options& opts) {
+    StreamState stream = stream_state(opts);
+    BackgroundModel* bg = stream.bg.get();
+    ChangeGate* gate = stream.gate.get();
+    int status = 0;
+    while (!reader.done()) {
+        if (opts.inputs.size() > 1) LOG_RESULT("== %s", reader.path().c_str());
+        Frame frame;
+        if (!reader.read(opts.raw, frame)) {
+            status = 1;
+            continue;
+        }
+        CardResult result;
+        if (gate && gate_unchanged(*gate, frame)) {
+            result = gate->result;
+        } else {
+            recognize_frame(frame, opts, result, bg);
+            if (gate) gate_store(*gate, result);
+        }
+        if (!result.located) status = 1;
+        print_result(result);
+    }
+    return status;
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parse_options(argc, argv, opts)) {
+        log_flush();
+        print_usage(argv[0]);
+        return 1;
+    }
+    Logger::instance().level.store((int)opts.logLevel);
+    DebugWriter::instance().mode.store((int)opts.debugArtifacts);
+    if (!opts.benchLabels.empty()) return run_benchmark(opts.benchLabels, opts.colorPrefilter, opts.frameThreshold,
+                                                       opts.cornerThreshold, opts.cornerMethod, opts.localizer,
+                                                       opts.denoise, opts.raw);
+    if (!opts.shmName.empty()) {
+#ifdef __linux__
+        return run_shm_consumer(opts.shmName, opts);
+#else
+        LOG_ERROR("--shm je podrzan samo na Linuxu");
+        return 1;
+#endif
+    }
+    if (!opts.watchDirs.empty()) {
+#ifdef __linux__
+        return run_watch(opts);
+#else
+        LOG_ERROR("--watch je podrzan samo na Linuxu");
+        return 1;
+#endif
+    }
+
+    if (opts.usePipeline) return Pipeline(opts.inputs, opts).run();
+    const bool batched = opts.matcher == MatcherMode::Batched;
+    if (opts.reader == ReaderMode::Mmap) {
+        BatchReader reader(opts.inputs);
+        return batched ? process_inputs_batched(reader, opts) : process_inputs(reader, opts);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PrefetchReader reader(opts.inputs, opts.reader, opts.ioDepth);
+    int status = batched ? process_inputs_batched(reader, opts) : process_inputs(reader, opts);
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("[IO] %s, dubina %d: %.1f MB, cekanje na citanje %.1f ms od %.1f ms ukupno", reader.backend(),
+             opts.ioDepth, reader.bytesRead / 1e6, reader.ioWaitNs / 1e6, totalMs);
+    return status;
 }
@@ -0,0 +1,151 @@
+// Zamjena za kameru: upisuje slike u shared-memory prsten frejmova (frame_ring.h)
+// zadatom brzinom, kako bi se main --shm=/ime mogao testirati bez kamere.
+//
+//   g++ -O2 shm_producer.cpp -o shm_producer
+//   ./shm_producer --name=/karte --fps=30 --count=300 --format=nv12 tst_slike/*.jpeg
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "frame_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct SourceImage {
+    int width, height;
+    uint32_t format, stride;
+    std::vector<unsigned char> pixels;
+};
+
+// RGB -> NV12 (BT.601, ograničeni opseg); širina i visina se svode na parne
+SourceImage to_nv12(const unsigned char* rgb, int w, int h) {
+    SourceImage img;
+    img.width = w & ~1;
+    img.height = h & ~1;
+    img.format = FRAME_NV12;
+    img.stride = img.width;
+    img.pixels.resize((size_t)img.width * img.height * 3 / 2);
+    unsigned char* Y = img.pixels.data();
+    unsigned char* UV = Y + (size_t)img.width * img.height;
+    for (int y = 0; y < img.height; ++y)
+        for (int x = 0; x < img.width; ++x) {
+            const unsigned char* p = rgb + ((size_t)y * w + x) * 3;
+            Y[(size_t)y * img.width + x] = (unsigned char)(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+        }
+    for (int y = 0; y < img.height / 2; ++y)
+        for (int x = 0; x < img.width / 2; ++x) {
+            const unsigned char* p = rgb + ((size_t)(2 * y) * w + 2 * x) * 3;
+            UV[(size_t)y * img.width + 2 * x] = (unsigned char)(((-38 * p[0] - 74 * p[1] + 112 * p[2] + 128) >> 8) + 128);
+            UV[(size_t)y * img.width + 2 * x + 1] = (unsigned char)(((112 * p[0] - 94 * p[1] - 18 * p[2] + 128) >> 8) + 128);
+        }
+    return img;
+}
+
+int main(int argc, char** argv) {
+    std::string name = "/karte";
+    int slots = 4, fps = 30, count = 0;
+    bool nv12 = false;
+    std::vector<SourceImage> images;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--name=", 0) == 0) name = arg.substr(7);
+        else if (arg.rfind("--slots=", 0) == 0) slots = std::max(2, atoi(arg.c_str() + 8));
+        else if (arg.rfind("--fps=", 0) == 0) fps = atoi(arg.c_str() + 6);
+        else if (arg.rfind("--count=", 0) == 0) count = atoi(arg.c_str() + 8);
+        else if (arg == "--format=nv12") nv12 = true;
+        else if (arg == "--format=rgb") nv12 = false;
+        else if (arg.rfind("--", 0) == 0) {
+            fprintf(stderr, "Nepoznata opcija: %s\n", arg.c_str());
+            return 1;
+        } else {
+            int w, h, c;
+            unsigned char* rgb = stbi_load(arg.c_str(), &w, &h, &c, 3);
+            if (!rgb) {
+                fprintf(stderr, "Greska pri ucitavanju slike: %s\n", arg.c_str());
+                return 1;
+            }
+            if (nv12) {
+                images.push_back(to_nv12(rgb, w, h));
+            } else {
+                images.push_back({w, h, FRAME_RGB, (uint32_t)w * 3, std::vector<unsigned char>(rgb, rgb + (size_t)w * h * 3)});
+            }
+            stbi_image_free(rgb);
+        }
+    }
+    if (images.empty()) {
+        fprintf(stderr, "Upotreba: %s [--name=/karte] [--slots=4] [--fps=30] [--count=N] [--format=rgb|nv12] slika...\n",
+                argv[0]);
+        return 1;
+    }
+    if (count <= 0) count = (int)images.size();
+
+    size_t maxBytes = 0;
+    for (const auto& img : images) maxBytes = std::max(maxBytes, img.pixels.size());
+    uint32_t slotBytes = frame_slot_bytes(maxBytes);
+    size_t size = frame_ring_size(slots, slotBytes);
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, size) != 0) {
+        perror("shm_open");
+        return 1;
+    }
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(name.c_str());
+        return 1;
+    }
+
+    // ftruncate daje nule, pa su atomici već inicijalizovani; magic se upisuje posljednji
+    auto* ring = static_cast<FrameRingHeader*>(mem);
+    ring->version = FRAME_RING_VERSION;
+    ring->slotCount = slots;
+    ring->slotBytes = slotBytes;
+    ring->magic.store(FRAME_RING_MAGIC, std::memory_order_release);
+
+    printf("Prsten %s: %d slotova x %u bajtova, %d frejmova\n", name.c_str(), slots, slotBytes, count);
+    fflush(stdout);
+
+    auto period = std::chrono::nanoseconds(fps > 0 ? 1000000000LL / fps : 0);
+    auto next = std::chrono::steady_clock::now();
+    for (uint64_t n = 0; n < (uint64_t)count; ++n) {
+        const SourceImage& img = images[n % images.size()];
+        FrameSlotHeader* slot = frame_ring_slot(ring, n);
+        slot->seq.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot->format = img.format;
+        slot->width = img.width;
+        slot->height = img.height;
+        slot->stride = img.stride;
+        slot->bytes = (uint32_t)img.pixels.size();
+        slot->timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        memcpy(frame_slot_data(slot), img.pixels.data(), img.pixels.size());
+        slot->seq.store(2 * n + 2, std::memory_order_release);
+
+        ring->published.store((uint32_t)(n + 1), std::memory_order_seq_cst);
+        frame_ring_wake(ring);
+
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+
+    ring->closed.store(1, std::memory_order_seq_cst);
+    frame_ring_wake(ring);
+    munmap(mem, size);
+    shm_unlink(name.c_str());
+    return 0;
+}